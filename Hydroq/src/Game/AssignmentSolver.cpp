@@ -0,0 +1,136 @@
+#include "AssignmentSolver.h"
+#include <climits>
+#include <unordered_map>
+
+void AssignmentSolver::Solve(int tasksNum, int workersNum, const vector<AssignmentEdge>& edges, vector<int>& output) {
+	output.assign(tasksNum, -1);
+	if (tasksNum == 0 || workersNum == 0 || edges.empty()) return;
+
+	// tasks and workers connected by allowed pairs form groups that don't affect each other
+	vector<int> groups(tasksNum + workersNum);
+	for (int i = 0; i < groups.size(); i++) {
+		groups[i] = i;
+	}
+
+	for (auto& edge : edges) {
+		groups[FindGroup(groups, edge.task)] = FindGroup(groups, tasksNum + edge.worker);
+	}
+
+	// pairs of each group
+	unordered_map<int, vector<AssignmentEdge>> groupEdges;
+	for (auto& edge : edges) {
+		groupEdges[FindGroup(groups, edge.task)].push_back(edge);
+	}
+
+	for (auto& group : groupEdges) {
+		SolveGroup(group.second, output);
+	}
+}
+
+int AssignmentSolver::FindGroup(vector<int>& groups, int item) {
+	while (groups[item] != item) {
+		// halve the way to the representative
+		groups[item] = groups[groups[item]];
+		item = groups[item];
+	}
+	return item;
+}
+
+void AssignmentSolver::SolveGroup(const vector<AssignmentEdge>& edges, vector<int>& output) {
+	// local indices of tasks and workers of the group
+	unordered_map<int, int> taskIndices;
+	unordered_map<int, int> workerIndices;
+	vector<int> tasks;
+	vector<int> workers;
+
+	for (auto& edge : edges) {
+		if (taskIndices.insert(make_pair(edge.task, tasks.size())).second) tasks.push_back(edge.task);
+		if (workerIndices.insert(make_pair(edge.worker, workers.size())).second) workers.push_back(edge.worker);
+	}
+
+	// the smaller side goes to the rows so that no padding is needed
+	bool tasksInRows = tasks.size() <= workers.size();
+	int rowsNum = tasksInRows ? tasks.size() : workers.size();
+	int columnsNum = tasksInRows ? workers.size() : tasks.size();
+
+	// pairs that aren't allowed get a cost higher than any matching of allowed pairs,
+	// so that the number of assigned tasks is maximized first
+	long long forbiddenCost = 1;
+	for (auto& edge : edges) {
+		forbiddenCost += edge.cost;
+	}
+
+	vector<long long> costs(rowsNum*columnsNum, forbiddenCost);
+	for (auto& edge : edges) {
+		int task = taskIndices[edge.task];
+		int worker = workerIndices[edge.worker];
+		long long& cost = tasksInRows ? costs[task*columnsNum + worker] : costs[worker*columnsNum + task];
+		cost = min(cost, (long long)edge.cost);
+	}
+
+	// Hungarian method with potentials; rows and columns are indexed from 1, column 0 is virtual
+	vector<long long> rowPotentials(rowsNum + 1, 0);
+	vector<long long> columnPotentials(columnsNum + 1, 0);
+	// row assigned to each column
+	vector<int> columnRows(columnsNum + 1, 0);
+	// previous column on the augmenting path
+	vector<int> way(columnsNum + 1, 0);
+	vector<long long> minSlack(columnsNum + 1);
+	vector<unsigned char> used(columnsNum + 1);
+
+	for (int row = 1; row <= rowsNum; row++) {
+		columnRows[0] = row;
+		int column = 0;
+		fill(minSlack.begin(), minSlack.end(), LLONG_MAX);
+		fill(used.begin(), used.end(), 0);
+
+		// find an augmenting path from the new row
+		do {
+			used[column] = 1;
+			int actualRow = columnRows[column];
+			long long delta = LLONG_MAX;
+			int nextColumn = 0;
+
+			for (int j = 1; j <= columnsNum; j++) {
+				if (!used[j]) {
+					long long slack = costs[(actualRow - 1)*columnsNum + j - 1] - rowPotentials[actualRow] - columnPotentials[j];
+					if (slack < minSlack[j]) {
+						minSlack[j] = slack;
+						way[j] = column;
+					}
+					if (minSlack[j] < delta) {
+						delta = minSlack[j];
+						nextColumn = j;
+					}
+				}
+			}
+
+			for (int j = 0; j <= columnsNum; j++) {
+				if (used[j]) {
+					rowPotentials[columnRows[j]] += delta;
+					columnPotentials[j] -= delta;
+				}
+				else {
+					minSlack[j] -= delta;
+				}
+			}
+
+			column = nextColumn;
+		} while (columnRows[column] != 0);
+
+		// flip the augmenting path
+		do {
+			int previousColumn = way[column];
+			columnRows[column] = columnRows[previousColumn];
+			column = previousColumn;
+		} while (column != 0);
+	}
+
+	for (int j = 1; j <= columnsNum; j++) {
+		int row = columnRows[j] - 1;
+		if (row == -1 || costs[row*columnsNum + j - 1] >= forbiddenCost) continue;
+
+		if (tasksInRows) output[tasks[row]] = workers[j - 1];
+		else output[tasks[j - 1]] = workers[row];
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Vec2i.h"
+
+using namespace Cog;
+
+/**
+* Pair of a task and a worker that may be assigned to each other
+*/
+struct AssignmentEdge {
+	// index of the task
+	int task;
+	// index of the worker
+	int worker;
+	// cost of the assignment (e.g. length of the path of the worker to the task)
+	int cost;
+
+	AssignmentEdge(int task, int worker, int cost) : task(task), worker(worker), cost(cost) {
+
+	}
+};
+
+/**
+* Solver of the assignment problem by the Hungarian method; among the allowed pairs
+* it finds the matching of tasks and workers with the highest number of assigned tasks
+* and, among those, with the lowest total cost
+* Only tasks and workers that appear in the allowed pairs are considered, and each connected
+* group of them is solved separately, hence the cost depends on the number of pairs, not on
+* the number of all workers
+*/
+class AssignmentSolver {
+public:
+
+	/**
+	* Finds the optimal matching
+	* @param tasksNum number of tasks
+	* @param workersNum number of workers
+	* @param edges allowed pairs of tasks and workers
+	* @param output output index of the worker for each task, -1 for tasks that remain unassigned
+	*/
+	static void Solve(int tasksNum, int workersNum, const vector<AssignmentEdge>& edges, vector<int>& output);
+
+private:
+
+	/**
+	* Finds the optimal matching of one connected group of tasks and workers
+	* @param edges allowed pairs of the group
+	* @param output output index of the worker for each task
+	*/
+	static void SolveGroup(const vector<AssignmentEdge>& edges, vector<int>& output);
+
+	/**
+	* Gets representative of the group of selected item (tasks first, then workers)
+	*/
+	static int FindGroup(vector<int>& groups, int item);
+};
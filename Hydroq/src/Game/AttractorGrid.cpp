@@ -0,0 +1,66 @@
+#include "AttractorGrid.h"
+
+void AttractorGrid::Init(int mapWidth, int mapHeight) {
+	columns = (mapWidth + ATTRACTOR_GRID_CELL_SIZE - 1) / ATTRACTOR_GRID_CELL_SIZE;
+	rows = (mapHeight + ATTRACTOR_GRID_CELL_SIZE - 1) / ATTRACTOR_GRID_CELL_SIZE;
+	cells.clear();
+}
+
+void AttractorGrid::AddAttractor(Faction faction, int attractorId, Vec2i position) {
+	auto& factionCells = cells[faction];
+	if (factionCells.empty()) {
+		factionCells.resize(columns*rows);
+	}
+
+	AttractorEntry entry;
+	entry.id = attractorId;
+	entry.center = ofVec2f(position.x + 0.5f, position.y + 0.5f);
+	factionCells[GetCellIndex(entry.center)].push_back(entry);
+}
+
+void AttractorGrid::RemoveAttractor(Faction faction, int attractorId, Vec2i position) {
+	auto found = cells.find(faction);
+	if (found == cells.end()) {
+		return;
+	}
+
+	auto& cell = found->second[GetCellIndex(ofVec2f(position.x + 0.5f, position.y + 0.5f))];
+	for (int i = 0; i < cell.size(); i++) {
+		if (cell[i].id == attractorId) {
+			cell[i] = cell.back();
+			cell.pop_back();
+			return;
+		}
+	}
+}
+
+bool AttractorGrid::IsNearAttractor(Faction faction, ofVec2f position, float distance, int ignoredId) const {
+	auto found = cells.find(faction);
+	if (found == cells.end()) {
+		return false;
+	}
+
+	auto& factionCells = found->second;
+	int cellIndex = GetCellIndex(position);
+	int column = cellIndex % columns;
+	int row = cellIndex / columns;
+	float distanceSq = distance*distance;
+
+	// the distance doesn't exceed the size of a cell, hence only the neighbouring cells are searched
+	for (int i = max(row - 1, 0); i <= min(row + 1, rows - 1); i++) {
+		for (int j = max(column - 1, 0); j <= min(column + 1, columns - 1); j++) {
+			for (auto& entry : factionCells[i*columns + j]) {
+				if (entry.id != ignoredId && entry.center.distanceSquared(position) < distanceSq) {
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+int AttractorGrid::GetCellIndex(ofVec2f position) const {
+	int column = min(max((int)position.x / ATTRACTOR_GRID_CELL_SIZE, 0), columns - 1);
+	int row = min(max((int)position.y / ATTRACTOR_GRID_CELL_SIZE, 0), rows - 1);
+	return row*columns + column;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "HydroqDef.h"
+#include "Vec2i.h"
+
+using namespace Cog;
+
+// size of a cell of the attractor grid, in tiles; no query may use a larger distance
+#define ATTRACTOR_GRID_CELL_SIZE 5
+
+/**
+* Spatial grid of attractors; attractors of each faction are partitioned into square cells,
+* so that a proximity query has to look only into the cell of the queried position and
+* into its neighbours
+*/
+class AttractorGrid {
+private:
+
+	/**
+	* Attractor stored in a cell
+	*/
+	struct AttractorEntry {
+		// id of the attractor node
+		int id;
+		// center of the attractor tile
+		ofVec2f center;
+	};
+
+	// number of cells in a row
+	int columns = 0;
+	// number of cells in a column
+	int rows = 0;
+	// attractors in each cell, for each faction
+	map<Faction, vector<vector<AttractorEntry>>> cells;
+
+public:
+
+	/**
+	* Initializes the grid for a map of selected size
+	*/
+	void Init(int mapWidth, int mapHeight);
+
+	/**
+	* Inserts an attractor located at selected tile
+	*/
+	void AddAttractor(Faction faction, int attractorId, Vec2i position);
+
+	/**
+	* Removes an attractor located at selected tile
+	*/
+	void RemoveAttractor(Faction faction, int attractorId, Vec2i position);
+
+	/**
+	* Returns true, if there is an attractor of selected faction whose center is closer
+	* than the given distance to selected position
+	* @param distance maximal distance, may not be greater than ATTRACTOR_GRID_CELL_SIZE
+	* @param ignoredId id of an attractor that should be ignored
+	*/
+	bool IsNearAttractor(Faction faction, ofVec2f position, float distance, int ignoredId = -1) const;
+
+private:
+
+	/**
+	* Gets index of the cell that contains selected position
+	*/
+	int GetCellIndex(ofVec2f position) const;
+};
@@ -0,0 +1,176 @@
+#include "FlowField.h"
+#include "GameMap.h"
+
+// offsets of neighbors in 8 directions (the opposite direction of i is (i+4)%8)
+static const int flowDirX[] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+static const int flowDirY[] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+
+FlowField::FlowField(GameMap* gameMap, Vec2i target) : gameMap(gameMap) {
+	this->target = gameMap->GetTileIndex(target);
+	Build();
+}
+
+Vec2i FlowField::GetTarget() const {
+	return gameMap->GetTilePosition(target);
+}
+
+int FlowField::GetCost(Vec2i position) {
+	Repair();
+	return costs[gameMap->GetTileIndex(position)];
+}
+
+Vec2i FlowField::GetNextStep(Vec2i position) {
+	Repair();
+	int direction = directions[gameMap->GetTileIndex(position)];
+	if (direction == FLOW_NO_DIRECTION) return position;
+	return Vec2i(position.x + flowDirX[direction], position.y + flowDirY[direction]);
+}
+
+bool FlowField::CalcPath(Vec2i start, vector<Vec2i>& output) {
+	Repair();
+
+	int actual = gameMap->GetTileIndex(start);
+	if (costs[actual] >= MAP_INFINITE_COST) return false;
+
+	output.push_back(start);
+
+	while (actual != target) {
+		int direction = directions[actual];
+		actual = gameMap->GetNeighborIndex(actual, flowDirX[direction], flowDirY[direction]);
+		output.push_back(gameMap->GetTilePosition(actual));
+	}
+
+	return true;
+}
+
+void FlowField::Build() {
+	int size = gameMap->GetWidth()*gameMap->GetHeight();
+	costs.assign(size, MAP_INFINITE_COST);
+	directions.assign(size, FLOW_NO_DIRECTION);
+	changedTiles.clear();
+
+	if (gameMap->IsPassable(target, true)) {
+		OpenList openList;
+		costs[target] = 0;
+		openList.push(make_pair(0, target));
+		Propagate(openList);
+	}
+}
+
+void FlowField::Repair() {
+	if (changedTiles.empty()) return;
+
+	// a change affects steps into and out of the tile and diagonal steps around its corners
+	vector<int> affected;
+	for (int changed : changedTiles) {
+		affected.push_back(changed);
+		for (int i = 0; i < 8; i++) {
+			int neighbor = gameMap->GetNeighborIndex(changed, flowDirX[i], flowDirY[i]);
+			if (neighbor != -1) affected.push_back(neighbor);
+		}
+	}
+	changedTiles.clear();
+	sort(affected.begin(), affected.end());
+	affected.erase(unique(affected.begin(), affected.end()), affected.end());
+
+	// invalidate tiles whose path has become more expensive, together with all tiles that lead through them
+	vector<int> invalid;
+	auto invalidate = [&](int index) {
+		costs[index] = MAP_INFINITE_COST;
+		directions[index] = FLOW_NO_DIRECTION;
+		invalid.push_back(index);
+	};
+
+	for (int tile : affected) {
+		if (costs[tile] >= MAP_INFINITE_COST) continue;
+
+		if (!gameMap->IsPassable(tile, true)) {
+			invalidate(tile);
+		}
+		else if (tile != target) {
+			int direction = directions[tile];
+			int next = gameMap->GetNeighborIndex(tile, flowDirX[direction], flowDirY[direction]);
+			int stepCost = gameMap->GetStepCost(tile, flowDirX[direction], flowDirY[direction], true);
+			if (stepCost == -1 || stepCost + costs[next] > costs[tile]) {
+				invalidate(tile);
+			}
+		}
+	}
+
+	for (int i = 0; i < invalid.size(); i++) {
+		for (int j = 0; j < 8; j++) {
+			int neighbor = gameMap->GetNeighborIndex(invalid[i], flowDirX[j], flowDirY[j]);
+			if (neighbor != -1 && directions[neighbor] == (j + 4) % 8) {
+				invalidate(neighbor);
+			}
+		}
+	}
+
+	// seed the propagation with the best known steps of invalidated and affected tiles
+	OpenList openList;
+
+	if (costs[target] != 0 && gameMap->IsPassable(target, true)) {
+		costs[target] = 0;
+		directions[target] = FLOW_NO_DIRECTION;
+		openList.push(make_pair(0, target));
+	}
+
+	auto seed = [&](int index) {
+		if (index == target || !gameMap->IsPassable(index, true)) return;
+		int direction;
+		int cost = CalcBestStep(index, direction);
+		if (cost < costs[index]) {
+			costs[index] = cost;
+			directions[index] = direction;
+			openList.push(make_pair(cost, index));
+		}
+	};
+
+	for (int tile : invalid) seed(tile);
+	for (int tile : affected) seed(tile);
+
+	Propagate(openList);
+}
+
+int FlowField::CalcBestStep(int index, int& direction) const {
+	int bestCost = MAP_INFINITE_COST;
+	direction = FLOW_NO_DIRECTION;
+
+	for (int i = 0; i < 8; i++) {
+		int stepCost = gameMap->GetStepCost(index, flowDirX[i], flowDirY[i], true);
+		if (stepCost == -1) continue;
+
+		int neighbor = gameMap->GetNeighborIndex(index, flowDirX[i], flowDirY[i]);
+		if (costs[neighbor] < MAP_INFINITE_COST && costs[neighbor] + stepCost < bestCost) {
+			bestCost = costs[neighbor] + stepCost;
+			direction = i;
+		}
+	}
+
+	return bestCost;
+}
+
+void FlowField::Propagate(OpenList& openList) {
+	while (!openList.empty()) {
+		auto top = openList.top();
+		openList.pop();
+		int actual = top.second;
+		if (top.first > costs[actual]) continue;
+
+		// relax tiles that can step into the actual one
+		for (int i = 0; i < 8; i++) {
+			int neighbor = gameMap->GetNeighborIndex(actual, flowDirX[i], flowDirY[i]);
+			if (neighbor == -1) continue;
+
+			int opposite = (i + 4) % 8;
+			int stepCost = gameMap->GetStepCost(neighbor, flowDirX[opposite], flowDirY[opposite], true);
+			if (stepCost == -1 || !gameMap->IsPassable(neighbor, true)) continue;
+
+			if (top.first + stepCost < costs[neighbor]) {
+				costs[neighbor] = top.first + stepCost;
+				directions[neighbor] = opposite;
+				openList.push(make_pair(costs[neighbor], neighbor));
+			}
+		}
+	}
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Vec2i.h"
+#include <queue>
+
+using namespace Cog;
+
+class GameMap;
+
+// direction of tiles that don't lead anywhere
+#define FLOW_NO_DIRECTION 8
+
+/**
+* Flow field leading to one target tile; contains cost to the target (integration field)
+* and the direction of the next step for each tile, so that any number of units heading
+* to the same target can follow it without searching for their own paths
+* Forbidden area may be crossed with a penalty
+*/
+class FlowField {
+private:
+	// open list of the propagation (pairs of cost and tile index, the cheapest at the top)
+	typedef priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> OpenList;
+
+	// link to the map
+	GameMap* gameMap;
+	// index of the target tile
+	int target;
+	// cost of the path to the target for each tile
+	vector<int> costs;
+	// direction of the next step for each tile (index into the collection of 8 directions)
+	vector<unsigned char> directions;
+	// tiles that have changed since the last repair
+	vector<int> changedTiles;
+
+public:
+
+	/**
+	* Creates a new flow field; use GameMap::GetFlowField so that the field is shared and kept up to date
+	*/
+	FlowField(GameMap* gameMap, Vec2i target);
+
+	/**
+	* Gets position of the target
+	*/
+	Vec2i GetTarget() const;
+
+	/**
+	* Gets cost of the path from selected position to the target (MAP_INFINITE_COST if unreachable)
+	*/
+	int GetCost(Vec2i position);
+
+	/**
+	* Gets the next tile on the path from selected position to the target;
+	* returns the position itself for the target or unreachable tiles
+	*/
+	Vec2i GetNextStep(Vec2i position);
+
+	/**
+	* Follows the field from selected position to the target
+	* @param output output collection of steps, including the start and the target
+	* @return true, if the target is reachable
+	*/
+	bool CalcPath(Vec2i start, vector<Vec2i>& output);
+
+	/**
+	* Notifies the field that a tile has changed; the field is repaired on the next access
+	*/
+	void OnTileChanged(int index) {
+		changedTiles.push_back(index);
+	}
+
+private:
+
+	/**
+	* Calculates the whole field
+	*/
+	void Build();
+
+	/**
+	* Repairs the field around tiles that have changed
+	*/
+	void Repair();
+
+	/**
+	* Gets the best step from a tile using the actual costs of its neighbors
+	* @param direction output direction of the step
+	* @return cost of the tile through the best neighbor
+	*/
+	int CalcBestStep(int index, int& direction) const;
+
+	/**
+	* Propagates costs from the tiles in the open list to their neighbors (Dijkstra)
+	*/
+	void Propagate(OpenList& openList);
+};
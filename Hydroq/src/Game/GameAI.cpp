@@ -115,56 +115,43 @@ void GameAI::CalcRigsDistance() {
 		emptyPos.push_back(emptyRig->GetTransform().localPos);
 	}
 
+	// distances are measured from the tiles the rigs are placed at
+	vector<Vec2i> blueSources;
+	vector<Vec2i> redSources;
+	for (auto& pos : bluePos) blueSources.push_back(Vec2i(pos.x - 1, pos.y - 1));
+	for (auto& pos : redPos) redSources.push_back(Vec2i(pos.x - 1, pos.y - 1));
+
+	// distance maps are shared by both AIs and updated with every new bridge
+	auto blueDistances = map->GetRigDistanceMap(Faction::BLUE, blueSources);
+	auto redDistances = map->GetRigDistanceMap(Faction::RED, redSources);
+
 	if (!redRigs.empty() && !blueRigs.empty()) {
 		// calculate distance from to red rigs from blue faction
 		for (int i = 0; i < redRigs.size(); i++) {
-			CalcRigDistance(blueRigs, bluePos, redPos, i, blueRedDist);
+			CalcRigDistance(blueDistances, redPos[i], blueRedDist);
 		}
 
 		// calculate distance from to blue rigs from red faction
 		for (int i = 0; i < blueRigs.size(); i++) {
-			CalcRigDistance(redRigs, redPos, bluePos, i, redBlueDist);
+			CalcRigDistance(redDistances, bluePos[i], redBlueDist);
 		}
 	}
 
 	// calculate distance to empty rigs
 	for (int i = 0; i < emptyRigs.size(); i++) {
-		CalcRigDistance(blueRigs, bluePos, emptyPos, i, blueEmptyDist);
-		CalcRigDistance(redRigs, redPos, emptyPos, i, redEmptyDist);
+		CalcRigDistance(blueDistances, emptyPos[i], blueEmptyDist);
+		CalcRigDistance(redDistances, emptyPos[i], redEmptyDist);
 	}
 }
 
-void GameAI::CalcRigDistance(vector<Node*>& refRigs, vector<Vec2i>& refRigsPos, vector<Vec2i>& targetRigsPos, int index, vector<RigInfo>& distances) {
-	auto map = gameModel->GetMap();
-	int closest = 100000;
-	int closestIndex = 0;
-
-	// find nearest opponent rig, using simple manhattan distance
-	for (int j = 0; j < refRigs.size(); j++) {
-		int distance = Vec2i::ManhattanDist(refRigsPos[j], targetRigsPos[index]);
-		if (distance < closest) {
-			closest = distance;
-			closestIndex = j;
-		}
-	}
-
-	// calculate real distance, using A* algorithm
-	Vec2i start = Vec2i(refRigsPos[closestIndex].x - 1, refRigsPos[closestIndex].y - 1);
-	Vec2i end = Vec2i(targetRigsPos[index].x - 1, targetRigsPos[index].y - 1);
-	Vec2i nearest1;
-	Vec2i nearest2;
-
-	// calculate distance from A to B and from B to A ;calculation must be made twice, because if there is no path
-	// leading from A to B, the nearest bridge closest to both B and A must be calculated so that we will know where
-	// to start to build a bridge
-	int distance1 = map->CalcNearestReachablePosition(start, end, nearest1, closest * 2);
-	// if a path has been found, there is no need to make second calculation
-	int distance2 = distance1 == 0 ? 0 : map->CalcNearestReachablePosition(end, start, nearest2, closest * 3);
+void GameAI::CalcRigDistance(spt<RigDistanceMap> distanceMap, Vec2i targetRigPos, vector<RigInfo>& distances) {
+	Vec2i target = Vec2i(targetRigPos.x - 1, targetRigPos.y - 1);
 
+	// the distance is the number of bridges needed, the nearest tile is the shore the bridge should start from
 	RigInfo info;
-	info.distance = min(distance1, distance2);
-	info.nearest = nearest1;
-	info.position = targetRigsPos[index];
+	info.distance = distanceMap->GetDistance(target);
+	info.nearest = distanceMap->GetNearestShore(target);
+	info.position = targetRigPos;
 	distances.push_back(info);
 }
 
@@ -247,22 +234,32 @@ void GameAI::Task_Goto(RigInfo nearestRig, uint64 absolute) {
 	// place bridge marks 
 	auto map = gameModel->GetMap();
 	auto brick = map->GetTile(nearestRig.nearest);
+	Vec2i target = nearestRig.position;
+
+	// lead the bridge across the narrowest water to the land the rig can be reached from
+	Vec2i startShore, endShore;
+	if (map->CalcNearestReachablePosition(nearestRig.nearest, Vec2i(nearestRig.position.x - 1, nearestRig.position.y - 1),
+		startShore, endShore, 0) > 0) {
+		brick = map->GetTile(startShore);
+		target = endShore;
+	}
+
 	auto newTask = AITask(HydAIActionType::GOTO_EMPTY, absolute);
-	BuildAroundTile(nearestRig, brick, newTask, 5);
+	BuildAroundTile(target, brick, newTask, 5);
 
 	if (!newTask.positions.empty()) actualTask = newTask;
 }
 
-void GameAI::BuildAroundTile(RigInfo& nearestRig, GameMapTile* tile, AITask& task, int recursiveLevels) {
+void GameAI::BuildAroundTile(Vec2i target, GameMapTile* tile, AITask& task, int recursiveLevels) {
 	vector<GameMapTile*> neighbors;
 	tile->GetNeighborsFourDirections(neighbors);
 
 	int closerNeighborDist = 100000;
 	GameMapTile* closerNeighbor = nullptr;
 	for (auto neighbor : neighbors) {
-		// build bridge so that the rig will be closer
+		// build bridge so that the target will be closer
 		if (neighbor->GetMapTileType() == MapTileType::WATER) {
-			int distance = Vec2i::Distance(nearestRig.position, neighbor->GetPosition());
+			int distance = Vec2i::Distance(target, neighbor->GetPosition());
 			if (distance < closerNeighborDist) {
 				closerNeighborDist = distance;
 				closerNeighbor = neighbor;
@@ -278,7 +275,7 @@ void GameAI::BuildAroundTile(RigInfo& nearestRig, GameMapTile* tile, AITask& tas
 
 		// mark another position
 		if (recursiveLevels > 0) {
-			BuildAroundTile(nearestRig, closerNeighbor, task, recursiveLevels - 1);
+			BuildAroundTile(target, closerNeighbor, task, recursiveLevels - 1);
 		}
 	}
 }
\ No newline at end of file
@@ -38,9 +38,9 @@ struct AITask {
 struct RigInfo {
 	// position of rig
 	Vec2i position;
-	// position of nearest another rig
+	// nearest reachable tile on the way to the rig (the rig itself, if it can be reached)
 	Vec2i nearest;
-	// distance to nearest rig
+	// number of water tiles that must be bridged to get to the rig
 	int distance;
 };
 
@@ -95,19 +95,17 @@ protected:
 	void UpdateMonteCarlo(vector<RigInfo>& myOpponentDist, vector<RigInfo>& myEmptyDist, uint64 delta, uint64 absolute);
 
 	/**
-	* Calculates distances to rigs, using manhattan distance and A* path finding algorithm
+	* Calculates distances to rigs, using distance maps of both factions
 	*/
 	void CalcRigsDistance();
 
 	/**
-	* Calculates nearest distance to target rig
-	* @param refRigs all rigs the distance can be measured from
-	* @param refRigsPos positions of all rigs the distance can be measured from
-	* @param targetRigsPos positions of rigs to calculate
-	* @param index index of targetRigsPos collection, selecting the rig that will be calculated
+	* Reads distance to target rig from the distance map of the faction
+	* @param distanceMap distance map from rigs the distance is measured from
+	* @param targetRigPos position of the target rig
 	* @param distances output collection with distances to rig
 	*/
-	void CalcRigDistance(vector<Node*>& refRigs, vector<Vec2i>& refRigsPos, vector<Vec2i>& targetRigsPos, int index, vector<RigInfo>& distances);
+	void CalcRigDistance(spt<RigDistanceMap> distanceMap, Vec2i targetRigPos, vector<RigInfo>& distances);
 
 	/**
 	* Tries MonteCarlo tree search that selects a possible action
@@ -131,10 +129,10 @@ protected:
 
 	/**
 	* Recursively marks positions to build the path
-	* @param nearestRig nearest rig to which should the way lead
+	* @param target position to which should the way lead
 	* @param tile actual map tile
 	* @param task selected task
 	* @param recursiveLevels number of recursive calls that should be made
 	*/
-	void BuildAroundTile(RigInfo& nearestRig, GameMapTile* tile, AITask& task, int recursiveLevels);
+	void BuildAroundTile(Vec2i target, GameMapTile* tile, AITask& task, int recursiveLevels);
 };
\ No newline at end of file
@@ -1,124 +1,88 @@
 #include "GameMap.h"
 #include "MapLoader.h"
+#include "SearchArena.h"
+#include "MapSnapshot.h"
 
 
 // ===================================== GameMapNode ========================================
 
-
-GameMapTile* GameMapTile::FindWalkableNeighbor(Vec2i preferredDirection) {
-	if (preferredDirection.x == pos.x && preferredDirection.y <= pos.y) {
-		if (top != nullptr && top->IsWalkable()) return top;
-		if (left != nullptr && left->IsWalkable()) return left;
-		if (right != nullptr && right->IsWalkable()) return right;
-		if (bottom != nullptr && bottom->IsWalkable()) return bottom;
-	}
-	else if (preferredDirection.x == pos.x && preferredDirection.y > pos.y) {
-		if (bottom != nullptr && bottom->IsWalkable()) return bottom;
-		if (left != nullptr && left->IsWalkable()) return left;
-		if (right != nullptr && right->IsWalkable()) return right;
-		if (top != nullptr && top->IsWalkable()) return top;
-	}
-	else if (preferredDirection.x > pos.x && preferredDirection.y == pos.y) {
-		if (right != nullptr && right->IsWalkable()) return right;
-		if (top != nullptr && top->IsWalkable()) return top;
-		if (bottom != nullptr && bottom->IsWalkable()) return bottom;
-		if (left != nullptr && left->IsWalkable()) return left;
-	}
-	else if (preferredDirection.x <= pos.x && preferredDirection.y == pos.y) {
-		if (left != nullptr && left->IsWalkable()) return left;
-		if (top != nullptr && top->IsWalkable()) return top;
-		if (bottom != nullptr && bottom->IsWalkable()) return bottom;
-		if (right != nullptr && right->IsWalkable()) return right;
-	}
-	else if (preferredDirection.x <= pos.x && preferredDirection.y <= pos.y) {
-		if (left != nullptr && left->IsWalkable()) return left;
-		if (right != nullptr && right->IsWalkable()) return right;
-		if (top != nullptr && top->IsWalkable()) return top;
-		if (bottom != nullptr && bottom->IsWalkable()) return bottom;
-	}
-	else if (preferredDirection.x <= pos.x && preferredDirection.y > pos.y) {
-		if (left != nullptr && left->IsWalkable()) return left;
-		if (right != nullptr && right->IsWalkable()) return right;
-		if (bottom != nullptr && bottom->IsWalkable()) return bottom;
-		if (top != nullptr && top->IsWalkable()) return top;
-	}
-	else if (preferredDirection.x > pos.x && preferredDirection.y <= pos.y) {
-		if (right != nullptr && right->IsWalkable()) return right;
-		if (left != nullptr && left->IsWalkable()) return left;
-		if (top != nullptr && top->IsWalkable()) return top;
-		if (bottom != nullptr && bottom->IsWalkable()) return bottom;
-	}
-	else if (preferredDirection.x > pos.x && preferredDirection.y > pos.y) {
-		if (right != nullptr && right->IsWalkable()) return right;
-		if (left != nullptr && left->IsWalkable()) return left;
-		if (bottom != nullptr && bottom->IsWalkable()) return bottom;
-		if (top != nullptr && top->IsWalkable()) return top;
+// offsets of neighbors in 4 directions (top, right, bottom, left)
+static const int dirX4[] = { 0, 1, 0, -1 };
+static const int dirY4[] = { -1, 0, 1, 0 };
+// offsets of neighbors in 8 directions (clockwise, starting at top)
+static const int dirX8[] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+static const int dirY8[] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+
+GameMapTile* GameMapTile::FindWalkableNeighbor(const int* order) const {
+	for (int i = 0; i < 4; i++) {
+		int neighbor = gameMap->GetNeighborIndex(index, dirX4[order[i]], dirY4[order[i]]);
+		if (neighbor != -1 && gameMap->IsWalkable(neighbor)) return &gameMap->tiles[neighbor];
 	}
-
 	return nullptr;
 }
 
-void GameMapTile::FindWalkableNeighbors(int distance, vector<GameMapTile*>& output) {
+GameMapTile* GameMapTile::FindNeighborByType(MapTileType type, const int* order) const {
+	for (int i = 0; i < 4; i++) {
+		int neighbor = gameMap->GetNeighborIndex(index, dirX4[order[i]], dirY4[order[i]]);
+		if (neighbor != -1 && gameMap->tileTypes[neighbor] == type) return &gameMap->tiles[neighbor];
+	}
+	return nullptr;
+}
 
-	if (this->IsWalkable()) output.push_back(this);
+GameMapTile* GameMapTile::FindWalkableNeighbor(Vec2i preferredDirection) {
+	// orders of directions, indexed into dirX4 and dirY4
+	static const int topFirst[] = { 0, 3, 1, 2 };
+	static const int bottomFirst[] = { 2, 3, 1, 0 };
+	static const int rightFirst[] = { 1, 0, 2, 3 };
+	static const int leftFirst[] = { 3, 0, 2, 1 };
+	static const int leftRightTop[] = { 3, 1, 0, 2 };
+	static const int leftRightBottom[] = { 3, 1, 2, 0 };
+	static const int rightLeftTop[] = { 1, 3, 0, 2 };
+	static const int rightLeftBottom[] = { 1, 3, 2, 0 };
+
+	Vec2i pos = GetPosition();
+
+	if (preferredDirection.x == pos.x && preferredDirection.y <= pos.y) return FindWalkableNeighbor(topFirst);
+	else if (preferredDirection.x == pos.x && preferredDirection.y > pos.y) return FindWalkableNeighbor(bottomFirst);
+	else if (preferredDirection.x > pos.x && preferredDirection.y == pos.y) return FindWalkableNeighbor(rightFirst);
+	else if (preferredDirection.x <= pos.x && preferredDirection.y == pos.y) return FindWalkableNeighbor(leftFirst);
+	else if (preferredDirection.x <= pos.x && preferredDirection.y <= pos.y) return FindWalkableNeighbor(leftRightTop);
+	else if (preferredDirection.x <= pos.x && preferredDirection.y > pos.y) return FindWalkableNeighbor(leftRightBottom);
+	else if (preferredDirection.x > pos.x && preferredDirection.y <= pos.y) return FindWalkableNeighbor(rightLeftTop);
+	else return FindWalkableNeighbor(rightLeftBottom);
+}
 
-	if (distance > 0) {
-		if (top != nullptr) top->FindWalkableNeighbors(distance - 1, output);
-		if (topRight != nullptr) topRight->FindWalkableNeighbors(distance - 1, output);
-		if (right != nullptr) right->FindWalkableNeighbors(distance - 1, output);
-		if (bottomRight != nullptr) bottomRight->FindWalkableNeighbors(distance - 1, output);
-		if (bottom != nullptr) bottom->FindWalkableNeighbors(distance - 1, output);
-		if (left != nullptr) left->FindWalkableNeighbors(distance - 1, output);
-		if (topLeft != nullptr) topLeft->FindWalkableNeighbors(distance - 1, output);
-		if (bottomLeft != nullptr) bottomLeft->FindWalkableNeighbors(distance - 1, output);
-	}
+void GameMapTile::FindWalkableNeighbors(int distance, vector<GameMapTile*>& output) {
+	gameMap->FindWalkableTiles(GetPosition(), distance, output);
 }
 
 GameMapTile* GameMapTile::FindNeighborByType(MapTileType type, Vec2i preferredDirection) {
-	if (preferredDirection.x <= pos.x && preferredDirection.y <= pos.y) {
-		if (top != nullptr && top->mapTileType == type) return top;
-		if (left != nullptr && left->mapTileType == type) return left;
-		if (right != nullptr && right->mapTileType == type) return right;
-		if (bottom != nullptr && bottom->mapTileType == type) return bottom;
-	}
-	else if (preferredDirection.x <= pos.x && preferredDirection.y > pos.y) {
-		if (bottom != nullptr && bottom->mapTileType == type) return bottom;
-		if (left != nullptr && left->mapTileType == type) return left;
-		if (right != nullptr && right->mapTileType == type) return right;
-		if (top != nullptr && top->mapTileType == type) return top;
-	}
-	else if (preferredDirection.x > pos.x && preferredDirection.y <= pos.y) {
-		if (top != nullptr && top->mapTileType == type) return top;
-		if (right != nullptr && right->mapTileType == type) return right;
-		if (left != nullptr && left->mapTileType == type) return left;
-		if (bottom != nullptr && bottom->mapTileType == type) return bottom;
-	}
-	else if (preferredDirection.x > pos.x && preferredDirection.y > pos.y) {
-		if (bottom != nullptr && bottom->mapTileType == type) return bottom;
-		if (right != nullptr && right->mapTileType == type) return right;
-		if (left != nullptr && left->mapTileType == type) return left;
-		if (top != nullptr && top->mapTileType == type) return top;
-	}
-
-	return nullptr;
+	// orders of directions, indexed into dirX4 and dirY4
+	static const int topLeft[] = { 0, 3, 1, 2 };
+	static const int bottomLeft[] = { 2, 3, 1, 0 };
+	static const int topRight[] = { 0, 1, 3, 2 };
+	static const int bottomRight[] = { 2, 1, 3, 0 };
+
+	Vec2i pos = GetPosition();
+
+	if (preferredDirection.x <= pos.x && preferredDirection.y <= pos.y) return FindNeighborByType(type, topLeft);
+	else if (preferredDirection.x <= pos.x && preferredDirection.y > pos.y) return FindNeighborByType(type, bottomLeft);
+	else if (preferredDirection.x > pos.x && preferredDirection.y <= pos.y) return FindNeighborByType(type, topRight);
+	else return FindNeighborByType(type, bottomRight);
 }
 
 void GameMapTile::GetNeighbors(vector<GameMapTile*>& output) {
-	if (top != nullptr) output.push_back(top);
-	if (topRight != nullptr) output.push_back(topRight);
-	if (right != nullptr) output.push_back(right);
-	if (bottomRight != nullptr) output.push_back(bottomRight);
-	if (bottom != nullptr) output.push_back(bottom);
-	if (bottomLeft != nullptr) output.push_back(bottomLeft);
-	if (left != nullptr) output.push_back(left);
-	if (topLeft != nullptr) output.push_back(topLeft);
+	for (int i = 0; i < 8; i++) {
+		auto neighbor = GetNeighbor(dirX8[i], dirY8[i]);
+		if (neighbor != nullptr) output.push_back(neighbor);
+	}
 }
 
 void GameMapTile::GetNeighborsFourDirections(vector<GameMapTile*>& output) {
-	if (top != nullptr) output.push_back(top);
-	if (right != nullptr) output.push_back(right);
-	if (bottom != nullptr) output.push_back(bottom);
-	if (left != nullptr) output.push_back(left);
+	for (int i = 0; i < 4; i++) {
+		auto neighbor = GetNeighbor(dirX4[i], dirY4[i]);
+		if (neighbor != nullptr) output.push_back(neighbor);
+	}
 }
 
 
@@ -132,7 +96,20 @@ void GameMap::LoadMap(Settings mapConfig, string selectedMap) {
 	string mapPath = mapConfig.GetSettingVal("maps_files", selectedMap);
 
 	if (mapPath.empty()) throw ConfigErrorException(string_format("Path to map %s not found", selectedMap.c_str()));
-	
+
+	// compiled map is ready without decoding the image, unless the image or the tile names have changed
+	MapBinary binary;
+	if (binary.Open(MapBinary::GetBinaryPath(mapPath), MapBinary::CalcSourceHash(mapConfig, mapPath))) {
+		this->LoadMap(binary);
+		return;
+	}
+
+	LoadMapImage(mapConfig, mapPath);
+}
+
+void GameMap::LoadMapImage(Settings mapConfig, string mapPath) {
+	this->mapConfig = mapConfig;
+
 	// load map from PNG image
 	MapLoader mapLoad = MapLoader();
 	TileMap tileMap;
@@ -141,100 +118,352 @@ void GameMap::LoadMap(Settings mapConfig, string selectedMap) {
 }
 
 void GameMap::LoadMap(TileMap& tileMap) {
+	// offsets of platforms from the top-left tile of a rig
+	static const int platformX[] = { -1, 0, 1, 2, 2, 2, 2, 1, 0, -1, -1, -1 };
+	static const int platformY[] = { -1, -1, -1, -1, 0, 1, 2, 2, 2, 2, 1, 0 };
+
 	this->width = tileMap.width;
 	this->height = tileMap.height;
-	gridNoBlock = GridGraph(width, height);
-	gridWithBlocks = GridGraph(width, height);
+
+	int size = width*height;
+	tileTypes.assign(size, MapTileType::NONE);
+	tileIndices.assign(size, 0);
+	tileOccupied.assign(size, 0);
+	tileForbidden.assign(size, 0);
+	rigs.clear();
+	rigPlatforms.clear();
+	InitTiles();
 
 	for (int j = 0; j < height; j++) {
 		for (int i = 0; i < width; i++) {
 			
 			Tile br = tileMap.GetTile(i, j);
-			GameMapTile* tile = new GameMapTile();
+			int index = j*width + i;
 
-			tile->mapTileName = br.name;
-			tile->mapTileTypeIndex = br.index;
-			tile->mapTileType = Helper::GetMapTileTypeByName(br.name);
-			tile->pos = Vec2i(i, j);
-			tiles.push_back(tile);
+			tileIndices[index] = br.index;
+			tileTypes[index] = Helper::GetMapTileTypeByName(br.name);
 
-			if (tile->mapTileType == MapTileType::RIG && tile->mapTileTypeIndex == 0) {
-				rigs.push_back(tile);
-			}
+			if (tileTypes[index] == MapTileType::RIG && br.index == 0) {
+				rigs.push_back(index);
 
-			// add obstruction into grid for A* search
-			if (!tile->IsWalkable()) {
-				gridNoBlock.AddBlock(i, j);
-				gridWithBlocks.AddBlock(i, j);
+				for (int k = 0; k < MAP_RIG_PLATFORMS; k++) {
+					rigPlatforms.push_back(GetNeighborIndex(index, platformX[k], platformY[k]));
+				}
 			}
 		}
 	}
 
-	// assign neighbors
-	for (auto tile : tiles) {
-		RefreshTile(tile);
+	walkableRowWords = (width + 63) / 64;
+	walkableBits.assign(walkableRowWords*height, 0);
+	for (int index = 0; index < size; index++) {
+		RefreshWalkableBit(index);
 	}
+
+	InitSearchStructures();
+}
+
+void GameMap::LoadMap(MapBinary& binary) {
+	this->width = binary.GetWidth();
+	this->height = binary.GetHeight();
+
+	int size = width*height;
+	auto types = reinterpret_cast<const MapTileType*>(binary.GetTileTypes());
+	tileTypes.assign(types, types + size);
+	tileIndices.assign(binary.GetTileIndices(), binary.GetTileIndices() + size);
+	tileOccupied.assign(size, 0);
+	tileForbidden.assign(size, 0);
+	rigs.assign(binary.GetRigs(), binary.GetRigs() + binary.GetRigsNum());
+	rigPlatforms.assign(binary.GetRigPlatforms(), binary.GetRigPlatforms() + binary.GetRigsNum()*MAP_RIG_PLATFORMS);
+	walkableRowWords = binary.GetWalkableRowWords();
+	walkableBits.assign(binary.GetWalkableBits(), binary.GetWalkableBits() + walkableRowWords*height);
+	InitTiles();
+
+	InitSearchStructures();
+}
+
+void GameMap::InitTiles() {
+	int size = width*height;
+	tiles.resize(size);
+
+	for (int index = 0; index < size; index++) {
+		tiles[index].gameMap = this;
+		tiles[index].index = index;
+	}
+}
+
+void GameMap::InitSearchStructures() {
+	hierarchicalMap.Init(this);
+	pathCache.Init(this);
+	connectivity.Init(this);
+	gapSearch.Init(this);
+	flowFields.clear();
+	rigDistanceMaps.clear();
+	snapshot = spt<MapSnapshot>();
+	snapshotChangedRows.clear();
 }
 
 void GameMap::RefreshTile(GameMapTile* tile) {
-	int i = tile->pos.x;
-	int j = tile->pos.y;
+	int index = tile->index;
 
-	// refresh neighbors
-	if (i > 0) tile->left = GetTile(i - 1, j); // left
-	if (i > 0 && j > 0) tile->topLeft = GetTile(i - 1, j - 1);	// topleft
-	if (i > 0 && j < (height - 1)) tile->bottomLeft = GetTile(i - 1, j + 1); // bottomleft
-	if (j > 0) tile->top = GetTile(i, j - 1); // top
-	if (j < (height - 1)) tile->bottom = GetTile(i, j + 1); // bottom
-	if (i < (width - 1)) tile->right = GetTile(i + 1, j); // right
-	if (i < (width - 1) && j < (height - 1)) tile->bottomRight = GetTile(i + 1, j + 1); // bottomright
-	if (i < (width - 1) && j > 0) tile->topRight = GetTile(i + 1, j - 1); // topright
+	// the tile may have been built or destroyed
+	RefreshWalkableBit(index);
 
-	// fix A* grid (the map may have changed)
-	if (tile->mapTileType == MapTileType::GROUND || tile->mapTileType == MapTileType::RIG_PLATFORM) {
-		gridNoBlock.RemoveBlock(i, j);
-		gridWithBlocks.RemoveBlock(i, j);
+	// the row will be copied by the next snapshot; snapshots in use by running queries aren't affected
+	if (snapshot) {
+		snapshotChangedRows.push_back(index / width);
 	}
-	else {
-		gridNoBlock.AddBlock(i, j);
-		gridWithBlocks.AddBlock(i, j);
+
+	// only the cluster of the tile needs to be rebuilt
+	hierarchicalMap.OnTileChanged(index);
+	// drop cached paths going through the tile
+	pathCache.OnTileChanged(index);
+	// join or split components
+	connectivity.OnTileChanged(index);
+
+	// flow fields are repaired lazily
+	for (auto& field : flowFields) {
+		field.second->OnTileChanged(index);
+	}
+
+	for (auto& distanceMap : rigDistanceMaps) {
+		distanceMap.second->OnTileChanged(index);
 	}
 
-	// map with forbidden areas is separate grid
-	if (tile->forbidden) {
-		gridWithBlocks.AddBlock(i, j);
+	// let the incremental planners repair their searches
+	for (auto& planner : pathPlanners) {
+		auto lockedPlanner = planner.second.lock();
+		if (lockedPlanner) lockedPlanner->OnTileChanged(index);
 	}
 }
 
-void GameMap::FindPath(Vec2i start, Vec2i end, bool crossForbiddenArea, vector<Vec2i>& output, int maxIteration) {
+void GameMap::FindPath(Vec2i start, Vec2i end, bool crossForbiddenArea, vector<Vec2i>& output, int maxIteration,
+	PathSearchBackend backend) {
 
-	COGMEASURE_BEGIN("HYDROQ_PATHFINDING");
+	// unreachable targets are rejected without any search
+	if (!MayBeConnected(start, end)) {
+		return;
+	}
 
-	AStarSearch srch;
-	AStarSearchContext context;
+	bool useHierarchicalMap = UseHierarchicalMap(start, end, crossForbiddenArea, maxIteration, backend);
+	if (backend == PathSearchBackend::DEFAULT) {
+		backend = defaultBackend;
+	}
 
-	// prefer grid with forbidden areas
-	bool found = srch.Search(gridWithBlocks, start, end, context, maxIteration);
-	// try it again for grid with forbidden areas
-	if (!found && crossForbiddenArea) {
-		context = AStarSearchContext();
-		found = srch.Search(gridNoBlock, start, end, context, maxIteration);
+	// the same paths are searched repeatedly by the scheduler and the workers
+	if (pathCache.GetPath(start, end, crossForbiddenArea, backend, maxIteration, output)) {
+		return;
 	}
 
-	if (found) {
-		srch.CalcPathFromSteps(start, end, context.steps, output);
+	COGMEASURE_BEGIN("HYDROQ_PATHFINDING");
+
+	// the buffer keeps its capacity between queries
+	auto& steps = pathSteps;
+	steps.clear();
+
+	if (useHierarchicalMap) {
+		// long path -> search over the clusters and refine the result
+		vector<Vec2i> abstractPath;
+		if (hierarchicalMap.FindAbstractPath(start, end, abstractPath) != -1) {
+			hierarchicalMap.RefinePath(abstractPath, steps);
+		}
+		// refined paths aren't the shortest ones, they can't be served to other queries
+		output.insert(output.end(), steps.begin(), steps.end());
+	}
+	else if (SearchGrid(start, end, crossForbiddenArea, steps, maxIteration, backend)) {
+		pathCache.InsertPath(start, end, crossForbiddenArea, backend, steps);
+		output.insert(output.end(), steps.begin(), steps.end());
 	}
 
 	COGMEASURE_END("HYDROQ_PATHFINDING");
 }
 
-int GameMap::CalcNearestReachablePosition(Vec2i start, Vec2i end, Vec2i& nearestBlock, int maxIteration) {
+bool GameMap::SearchGrid(Vec2i start, Vec2i end, bool crossForbiddenArea, vector<Vec2i>& output, int maxIteration,
+	PathSearchBackend backend) {
+
+	if (backend == PathSearchBackend::DEFAULT) {
+		backend = defaultBackend;
+	}
+
+	if (backend == PathSearchBackend::JPS) {
+		// prefer path that avoids forbidden areas
+		auto& search = JumpPointSearch::GetThreadSearch();
+		bool found = search.Search(*this, start, end, false, output, maxIteration);
+		if (!found && crossForbiddenArea) {
+			found = search.Search(*this, start, end, true, output, maxIteration);
+		}
+		return found;
+	}
+
+	// forbidden tiles carry a penalty -> one search finds a way around them, if there is any
+	return SearchArena::GetThreadArena().FindPath(*this, start, end, crossForbiddenArea, output, maxIteration);
+}
+
+void GameMap::FindPaths(vector<PathQuery>& queries) {
+	COGMEASURE_BEGIN("HYDROQ_PATHFINDING_BATCH");
 
-	AStarSearch srch;
-	AStarSearchContext context;
+	vector<PathQuery> pending;
+	vector<int> pendingIndices;
+
+	for (int i = 0; i < queries.size(); i++) {
+		auto& query = queries[i];
+		query.path.clear();
+
+		PathQuery pendingQuery = PathQuery(query.start, query.end, query.crossForbiddenArea, query.maxIteration,
+			query.backend == PathSearchBackend::DEFAULT ? defaultBackend : query.backend);
+
+		if (!MayBeConnected(query.start, query.end)
+			|| pathCache.GetPath(query.start, query.end, query.crossForbiddenArea, pendingQuery.backend, query.maxIteration, query.path)) {
+			continue;
+		}
+
+		if (UseHierarchicalMap(query.start, query.end, query.crossForbiddenArea, query.maxIteration, query.backend)) {
+			// long path -> the abstract graph can't be shared among threads, only the segments are searched in parallel
+			if (hierarchicalMap.FindAbstractPath(query.start, query.end, pendingQuery.waypoints) == -1) {
+				continue;
+			}
+		}
+
+		pending.push_back(pendingQuery);
+		pendingIndices.push_back(i);
+	}
+
+	if (!pending.empty()) {
+		if (!pathQueryPool) {
+			pathQueryPool = spt<PathQueryPool>(new PathQueryPool());
+		}
+
+		pathQueryPool->Process(GetSnapshot(), pending);
+
+		for (int i = 0; i < pending.size(); i++) {
+			auto& query = pending[i];
+			if (!query.path.empty()) {
+				// refined abstract paths aren't the shortest ones, they can't be served to other queries
+				if (query.waypoints.empty()) {
+					pathCache.InsertPath(query.start, query.end, query.crossForbiddenArea, query.backend, query.path);
+				}
+				queries[pendingIndices[i]].path.swap(query.path);
+			}
+		}
+	}
+
+	COGMEASURE_END("HYDROQ_PATHFINDING_BATCH");
+}
+
+bool GameMap::UseHierarchicalMap(Vec2i start, Vec2i end, bool crossForbiddenArea, int maxIteration, PathSearchBackend backend) const {
+	// a limited search or a selected backend must be honoured
+	return crossForbiddenArea && maxIteration == 0 && backend == PathSearchBackend::DEFAULT
+		&& Vec2i::ManhattanDist(start, end) > 2 * hierarchicalMap.GetClusterSize();
+}
+
+spt<MapSnapshot> GameMap::GetSnapshot() {
+	if (!snapshot) {
+		snapshot = spt<MapSnapshot>(new MapSnapshot(this));
+	}
+	else if (!snapshotChangedRows.empty()) {
+		sort(snapshotChangedRows.begin(), snapshotChangedRows.end());
+		snapshotChangedRows.erase(unique(snapshotChangedRows.begin(), snapshotChangedRows.end()), snapshotChangedRows.end());
+		snapshot = spt<MapSnapshot>(new MapSnapshot(this, *snapshot, snapshotChangedRows));
+	}
+
+	snapshotChangedRows.clear();
+	return snapshot;
+}
+
+void GameMap::FindWalkableTiles(Vec2i center, int radius, vector<GameMapTile*>& output) {
+	int minX = max(0, center.x - radius);
+	int maxX = min(width - 1, center.x + radius);
+	int minY = max(0, center.y - radius);
+	int maxY = min(height - 1, center.y + radius);
+	if (minX > maxX || minY > maxY) return;
+
+	for (int y = minY; y <= maxY; y++) {
+		const uint64* row = &walkableBits[y*walkableRowWords];
+
+		for (int word = minX / 64; word <= maxX / 64; word++) {
+			uint64 bits = row[word];
+			// cut off tiles outside the square
+			if (word == minX / 64) bits &= ~0ULL << (minX % 64);
+			if (word == maxX / 64 && maxX % 64 != 63) bits &= (1ULL << (maxX % 64 + 1)) - 1;
+
+			// words without walkable tiles are skipped at once
+			for (int x = word * 64; bits != 0; x++, bits >>= 1) {
+				if (bits & 1) output.push_back(&tiles[y*width + x]);
+			}
+		}
+	}
+}
+
+void GameMap::GetRigPlatforms(Vec2i rigPosition, vector<Vec2i>& output) const {
+	int rig = GetTileIndex(rigPosition);
+
+	for (int i = 0; i < rigs.size(); i++) {
+		if (rigs[i] == rig) {
+			for (int k = 0; k < MAP_RIG_PLATFORMS; k++) {
+				int platform = rigPlatforms[i*MAP_RIG_PLATFORMS + k];
+				if (platform != -1) output.push_back(GetTilePosition(platform));
+			}
+			return;
+		}
+	}
+}
+
+void GameMap::RefreshWalkableBit(int index) {
+	uint64& word = walkableBits[(index / width)*walkableRowWords + (index % width) / 64];
+	uint64 mask = 1ULL << ((index % width) % 64);
+	if (IsWalkable(index)) word |= mask;
+	else word &= ~mask;
+}
+
+spt<IncrementalPathPlanner> GameMap::GetPathPlanner(Vec2i start, Vec2i end, bool crossForbiddenArea) {
+	int key = GetPathPlannerKey(GetTileIndex(end), crossForbiddenArea);
+	auto found = pathPlanners.find(key);
+	auto planner = found != pathPlanners.end() ? found->second.lock() : spt<IncrementalPathPlanner>();
+
+	if (planner) {
+		// the search from the goal is reused, only the start is different
+		planner->SetStart(start);
+		return planner;
+	}
+
+	planner = spt<IncrementalPathPlanner>(new IncrementalPathPlanner(this, start, end, crossForbiddenArea));
+	pathPlanners[key] = planner;
+	return planner;
+}
+
+spt<FlowField> GameMap::GetFlowField(Vec2i target) {
+	int index = GetTileIndex(target);
+	auto found = flowFields.find(index);
+	if (found != flowFields.end()) {
+		return found->second;
+	}
+
+	if (flowFields.size() >= MAP_FLOW_FIELD_CAPACITY) {
+		// drop fields nobody follows anymore
+		for (auto it = flowFields.begin(); it != flowFields.end();) {
+			if (it->second.use_count() == 1) it = flowFields.erase(it);
+			else ++it;
+		}
+	}
+
+	COGMEASURE_BEGIN("HYDROQ_FLOWFIELD");
+	auto field = spt<FlowField>(new FlowField(this, target));
+	flowFields[index] = field;
+	COGMEASURE_END("HYDROQ_FLOWFIELD");
+	return field;
+}
+
+spt<RigDistanceMap> GameMap::GetRigDistanceMap(Faction faction, vector<Vec2i>& rigPositions) {
+	auto found = rigDistanceMaps.find(faction);
+	if (found != rigDistanceMaps.end() && found->second->GetSources() == rigPositions) {
+		return found->second;
+	}
+
+	// rigs have changed their owner
+	auto distanceMap = spt<RigDistanceMap>(new RigDistanceMap(this, rigPositions));
+	rigDistanceMaps[faction] = distanceMap;
+	return distanceMap;
+}
 
-	// prefer grid with forbidden areas
-	bool found = srch.Search(gridNoBlock, start, end, context, maxIteration);
-	nearestBlock = context.nearestBlock;
-	return context.nearestDistance;
+int GameMap::CalcNearestReachablePosition(Vec2i start, Vec2i end, Vec2i& startShore, Vec2i& endShore, int maxIteration) {
+	return gapSearch.Search(start, end, startShore, endShore, maxIteration);
 }
\ No newline at end of file
@@ -2,17 +2,37 @@
 
 #include "HydroqDef.h"
 #include "Helper.h"
-#include "AStarSearch.h"
 #include "Settings.h"
 #include "Vec2i.h"
 #include "Tile.h"
+#include "IncrementalPathPlanner.h"
+#include "HierarchicalMap.h"
+#include "PathCache.h"
+#include "MapConnectivity.h"
+#include "JumpPointSearch.h"
+#include "GapSearch.h"
+#include "FlowField.h"
+#include "RigDistanceMap.h"
+#include "PathQueryPool.h"
+#include "MapBinary.h"
 
 using namespace Cog;
 
+// cost of a straight step between two neighboring tiles
+#define MAP_STEP_COST 10
+// cost of a diagonal step between two neighboring tiles
+#define MAP_DIAGONAL_COST 14
+// additional cost of entering a forbidden tile, if the forbidden area may be crossed
+#define MAP_FORBIDDEN_PENALTY 1000
+// infinite path cost
+#define MAP_INFINITE_COST 0x3FFFFFFF
+// number of cached flow fields; fields that aren't used by anyone are dropped above this limit
+#define MAP_FLOW_FIELD_CAPACITY 16
+
 /**
 * Type of map tile
 */
-enum class MapTileType {
+enum class MapTileType : unsigned char {
 	NONE,		/** undefined */
 	WATER,		/** water */
 	GROUND,		/** bridge/ground*/
@@ -20,126 +40,102 @@ enum class MapTileType {
 	RIG_PLATFORM/** platform (the area closest to rig)*/
 };
 
+class GameMap;
+
 /**
-* Tile of game map
+* Tile of game map; only a thin view over the tile planes stored in the GameMap
 */
 class GameMapTile {
 private:
-	// type of tile
-	MapTileType mapTileType;
-	// index of tile (e.g. drilling rig has 4 parts)
-	int mapTileTypeIndex;
-	// name of tile
-	string mapTileName;
-	// indicator whether the tile is occupied by a building
-	bool occupied = false;
-	// indicator whether the tile is forbidden to cross
-	bool forbidden = false;
-	// position of tile
-	Vec2i pos;
-public:
+	// map the tile belongs to
+	GameMap* gameMap = nullptr;
+	// index of the tile in the tile planes
+	int index = 0;
+
+	/**
+	* Gets neighbor in selected direction or nullptr if it lies outside the map
+	*/
+	GameMapTile* GetNeighbor(int dirX, int dirY) const;
+
+	/**
+	* Gets walkable neighbor in the first direction of the given order that can be crossed
+	* @param order order of directions (indices into the collection of 4-direction offsets)
+	*/
+	GameMapTile* FindWalkableNeighbor(const int* order) const;
+
+	/**
+	* Gets neighbor of selected type in the first direction of the given order
+	*/
+	GameMapTile* FindNeighborByType(MapTileType type, const int* order) const;
 
-	// neighbors
-	GameMapTile* top = nullptr;
-	GameMapTile* topRight = nullptr;
-	GameMapTile* right = nullptr;
-	GameMapTile* bottomRight = nullptr;
-	GameMapTile* bottom = nullptr;
-	GameMapTile* bottomLeft = nullptr;
-	GameMapTile* left = nullptr;
-	GameMapTile* topLeft = nullptr;
+public:
 
 	/**
 	* Gets type of the tile
 	*/
-	MapTileType GetMapTileType() const {
-		return mapTileType;
-	}
+	MapTileType GetMapTileType() const;
 
 	/**
 	* Sets type of the tile
 	*/
-	void SetMapTileType(MapTileType newType) {
-		this->mapTileType = newType;
-		this->mapTileName = Helper::GetMapNameByTileType(newType);
-	}
+	void SetMapTileType(MapTileType newType);
 
 	/**
 	* Gets index of the map tile 
 	* (e.g. rigs consist of 4 parts) 
 	*/
-	int GetMapTileTypeIndex() const {
-		return mapTileTypeIndex;
-	}
+	int GetMapTileTypeIndex() const;
 
 	/**
 	* Sets index of the map tile
 	*/
-	void SetMapTileTypeIndex(int index) {
-		this->mapTileTypeIndex = index;
-	}
+	void SetMapTileTypeIndex(int index);
 
 	/**
 	* Gets name of the map tile
 	*/
-	string GetMapTileName() const {
-		return mapTileName;
-	}
+	string GetMapTileName() const;
 
 	/**
-	* Sets name of the tile
+	* Sets name of the tile (changes the type of the tile accordingly)
 	*/
-	void SetMapTileName(string name) {
-		this->mapTileName = name;
-	}
+	void SetMapTileName(string name);
 
 	/**
 	* Gets indicator whether the tile is occupied
 	*/
-	bool IsOccupied() const {
-		return occupied;
-	}
+	bool IsOccupied() const;
 
 	/**
 	* Sets indicator whether the tile is occupied
 	*/
-	void SetIsOccupied(bool occupied) {
-		this->occupied = occupied;
-	}
+	void SetIsOccupied(bool occupied);
 
 	/**
 	* Gets indicator whether the tile is forbidden
 	*/
-	bool IsForbidden() const {
-		return forbidden;
-	}
+	bool IsForbidden() const;
 
 	/**
 	* Sets indicator whether the tile is forbidden
 	*/
-	void SetIsForbidden(bool forbidden) {
-		this->forbidden = forbidden;
-	}
+	void SetIsForbidden(bool forbidden);
 
 	/**
 	* Gets indicator whether the tile is walkable
 	*/
-	bool IsWalkable() const {
-		return this->mapTileType == MapTileType::GROUND || this->mapTileType == MapTileType::RIG_PLATFORM;
-	}
+	bool IsWalkable() const;
 
 	/**
 	* Gets position of the tile
 	*/
-	Vec2i GetPosition() const {
-		return pos;
-	}
+	Vec2i GetPosition() const;
 
 	/**
-	* Sets position of the tile
+	* Gets index of the tile in the tile planes of the map
 	*/
-	void SetPosition(Vec2i pos) {
-		this->pos = pos;
+	int GetIndex() const {
+		return index;
 	}
 
 	/**
@@ -149,8 +145,8 @@ public:
 	GameMapTile* FindWalkableNeighbor(Vec2i preferredDirection);
 
 	/**
-	* Finds list of all walkable neighbors
-	* @param distance radius to explore (recursion is used here)
+	* Finds list of all walkable tiles in a square around this tile (each tile only once)
+	* @param distance radius to explore
 	* @param output output collection
 	*/
 	void FindWalkableNeighbors(int distance, vector<GameMapTile*>& output);
@@ -185,16 +181,70 @@ private:
 	int width;
 	// height of the map (in number of tiles)
 	int height;
-	// collection of all tiles
-	vector<GameMapTile*> tiles;
-	// grid without forbidden areas
-	GridGraph gridNoBlock; 
-	// grid with forbidden areas
-	GridGraph gridWithBlocks; 
-	// collection of drilling rigs
-	vector<GameMapTile*> rigs;
+	// plane of tile types
+	vector<MapTileType> tileTypes;
+	// plane of tile indices (e.g. drilling rig has 4 parts)
+	vector<unsigned char> tileIndices;
+	// plane of indicators whether the tile is occupied by a building
+	vector<unsigned char> tileOccupied;
+	// plane of indicators whether the tile is forbidden to cross
+	vector<unsigned char> tileForbidden;
+	// walkability of tiles, one bit per tile; each row starts at a new word
+	vector<uint64> walkableBits;
+	// number of words per row of walkableBits
+	int walkableRowWords = 0;
+	// views over the tile planes, one for each tile
+	vector<GameMapTile> tiles;
+	// indices of drilling rigs
+	vector<int> rigs;
+	// indices of platform tiles around each rig (MAP_RIG_PLATFORMS per rig, -1 outside the map)
+	vector<int> rigPlatforms;
 	// map configuration
 	Settings mapConfig;
+	// incremental planners that are notified about refreshed tiles, by their keys (see GetPathPlannerKey)
+	map<int, weak_ptr<IncrementalPathPlanner>> pathPlanners;
+	// abstract graph for long-distance queries
+	HierarchicalMap hierarchicalMap;
+	// recently found paths
+	PathCache pathCache;
+	// connected components of walkable tiles
+	MapConnectivity connectivity;
+	// search for water gaps between two positions
+	GapSearch gapSearch;
+	// backend used for queries that don't select any
+	PathSearchBackend defaultBackend = PathSearchBackend::ASTAR;
+	// flow fields by index of their target tile
+	map<int, spt<FlowField>> flowFields;
+	// distance maps from rigs of each faction
+	map<Faction, spt<RigDistanceMap>> rigDistanceMaps;
+	// the last snapshot, created on demand
+	spt<MapSnapshot> snapshot;
+	// rows of tiles refreshed since the last snapshot has been created
+	vector<int> snapshotChangedRows;
+	// threads for batches of path queries, created on demand
+	spt<PathQueryPool> pathQueryPool;
+	// buffer for steps of the actual path query
+	vector<Vec2i> pathSteps;
+
+	/**
+	* Updates walkability bit of the tile at selected index
+	*/
+	void RefreshWalkableBit(int index);
+
+	/**
+	* Resizes the tile views and binds them to the map
+	*/
+	void InitTiles();
+
+	/**
+	* Initializes search structures after the tile planes have been loaded
+	*/
+	void InitSearchStructures();
+
+	/**
+	* Returns true, if the path query should be searched over the hierarchical map
+	*/
+	bool UseHierarchicalMap(Vec2i start, Vec2i end, bool crossForbiddenArea, int maxIteration, PathSearchBackend backend) const;
 
 public:
 
@@ -205,16 +255,28 @@ public:
 	*/
 	void LoadMap(Settings mapConfig, string selectedMap);
 
+	/**
+	* Loads game map from map image, ignoring compiled maps
+	* @param mapConfig configuration of maps
+	* @param mapPath path to the map image
+	*/
+	void LoadMapImage(Settings mapConfig, string mapPath);
+
 	/**
 	* Loads game map from tile map
 	*/
 	void LoadMap(TileMap& tileMap);
 
+	/**
+	* Loads game map from compiled map
+	*/
+	void LoadMap(MapBinary& binary);
+
 	/**
 	* Refreshes tile at selected position
 	*/
 	void RefreshTile(Vec2i position) {
-		RefreshTile(GetTile(position.x, position.y));
+		RefreshTile(GetTile(position));
 	}
 
 	/**
@@ -223,36 +285,260 @@ public:
 	void RefreshTile(GameMapTile* tile);
 
 	/**
-	* Finds path from start to end, using A-star search algorithm
+	* Finds path from start to end, using A-star search algorithm or jump point search
+	* Long paths that may cross forbidden area are searched over the hierarchical map, unless
+	* the number of iterations is limited or the backend is selected; such paths needn't be the shortest
+	* Paths found by the grid search are cached for each backend until a tile they go through is refreshed
+	* Queries between different components of the map return immediately
 	* @param start start position
 	* @param end final position
 	* @param crossForbiddenArea if true, forbidden area may be crossed
 	* @param output output collection of steps
-	* @param maxIteration maximal number of iterations of the A* algorithm (0 for infinite)
+	* @param maxIteration maximal number of iterations of the search (0 for infinite)
+	* @param backend search algorithm
+	*/
+	void FindPath(Vec2i start, Vec2i end, bool crossForbiddenArea, vector<Vec2i>& output, int maxIteration = 0,
+		PathSearchBackend backend = PathSearchBackend::DEFAULT);
+
+	/**
+	* Searches the grid directly, without the cache and the hierarchical map; forbidden tiles
+	* carry a penalty, so that the path avoiding forbidden area is preferred
+	* @return true, if the path has been found
+	*/
+	bool SearchGrid(Vec2i start, Vec2i end, bool crossForbiddenArea, vector<Vec2i>& output, int maxIteration,
+		PathSearchBackend backend);
+
+	/**
+	* Gets backend used for queries that don't select any
+	*/
+	PathSearchBackend GetDefaultBackend() const {
+		return defaultBackend;
+	}
+
+	/**
+	* Sets backend used for queries that don't select any
+	*/
+	void SetDefaultBackend(PathSearchBackend backend) {
+		this->defaultBackend = backend == PathSearchBackend::DEFAULT ? PathSearchBackend::ASTAR : backend;
+	}
+
+	/**
+	* Returns false, if there is surely no path between both positions (they lie in different components of the map)
+	*/
+	bool MayBeConnected(Vec2i start, Vec2i end) const {
+		return connectivity.MayBeConnected(GetTileIndex(start), GetTileIndex(end));
+	}
+
+	/**
+	* Gets connected components of walkable tiles
+	*/
+	MapConnectivity& GetConnectivity() {
+		return connectivity;
+	}
+
+	/**
+	* Gets cache of recently found paths
+	*/
+	PathCache& GetPathCache() {
+		return pathCache;
+	}
+
+	/**
+	* Finds abstract path over the hierarchical map; forbidden area may be crossed with a penalty
+	* The waypoints can be refined later, piece by piece, by RefineAbstractPath
+	* @param start start position
+	* @param end final position
+	* @param output output collection of waypoints, including the start and the end
+	* @return true, if the path has been found
+	*/
+	bool FindAbstractPath(Vec2i start, Vec2i end, vector<Vec2i>& output) {
+		return MayBeConnected(start, end) && hierarchicalMap.FindAbstractPath(start, end, output) != -1;
+	}
+
+	/**
+	* Refines segment of an abstract path into steps
+	* @param from first waypoint
+	* @param to second waypoint
+	* @param output output collection the steps will be appended to (the first waypoint excluded)
+	* @return true, if the segment can still be passed
+	*/
+	bool RefineAbstractPath(Vec2i from, Vec2i to, vector<Vec2i>& output) {
+		return hierarchicalMap.RefineSegment(from, to, output);
+	}
+
+	/**
+	* Finds paths for a batch of queries; queries not found in the cache are processed
+	* in parallel over a snapshot of the map, using the backend of each query
+	* Long unlimited queries that may cross forbidden area are searched over the hierarchical map first,
+	* as in FindPath, and only the segments of their abstract paths are searched in parallel
+	* @param queries queries to process; the found paths are stored in them
+	*/
+	void FindPaths(vector<PathQuery>& queries);
+
+	/**
+	* Gets immutable snapshot of the actual state of the map; only the rows refreshed
+	* since the last snapshot are copied
+	*/
+	spt<MapSnapshot> GetSnapshot();
+
+	/**
+	* Gets incremental path planner that will be notified about refreshed tiles
+	* so that its search can be repaired instead of calculated again; the planner
+	* is shared by all callers heading to the same position
+	* @param start start position of the caller
+	* @param end final position
+	* @param crossForbiddenArea if true, forbidden area may be crossed
 	*/
-	void FindPath(Vec2i start, Vec2i end, bool crossForbiddenArea, vector<Vec2i>& output, int maxIteration = 0);
+	spt<IncrementalPathPlanner> GetPathPlanner(Vec2i start, Vec2i end, bool crossForbiddenArea);
 
 	/**
-	* Calculates nearest reachable position between starting and final position
+	* Finds all walkable tiles in a square around selected position, row by row
+	* @param center center of the square
+	* @param radius distance from the center to the edges of the square
+	* @param output output collection
+	*/
+	void FindWalkableTiles(Vec2i center, int radius, vector<GameMapTile*>& output);
+
+	/**
+	* Gets flow field leading to selected target; the field is shared by all callers
+	* and repaired whenever a tile is refreshed
+	*/
+	spt<FlowField> GetFlowField(Vec2i target);
+
+	/**
+	* Gets distance map from rigs of selected faction; the map is recalculated only if
+	* the positions of rigs have changed, otherwise it is updated with refreshed tiles
+	* @param faction faction the rigs belong to
+	* @param rigPositions positions of tiles the distances are measured from
+	*/
+	spt<RigDistanceMap> GetRigDistanceMap(Faction faction, vector<Vec2i>& rigPositions);
+
+	/**
+	* Calculates the shortest water gap between tiles reachable from starting position and tiles reachable
+	* from final position; both positions are searched at once
 	* @param start start position
 	* @param end final position
-	* @param nearestBlock output position of the nearest tile (if the path has been found, the value will be equal to final position)
-	* @param maxIteration maximal number of iterations of the A* algorithm (0 for infinite)
+	* @param startShore output reachable tile on the starting side the bridge should start from
+	* @param endShore output reachable tile on the final side the bridge leads to (equal to final position if it can be reached)
+	* @param maxIteration maximal number of expanded tiles (0 for infinite)
+	* @return number of water tiles that must be bridged (0 if the final position can be reached), -1 if no gap has been found
 	*/
-	int CalcNearestReachablePosition(Vec2i start, Vec2i end, Vec2i& nearestBlock, int maxIteration);
+	int CalcNearestReachablePosition(Vec2i start, Vec2i end, Vec2i& startShore, Vec2i& endShore, int maxIteration);
 
 	/**
 	* Gets tile at selected position
 	*/
-	GameMapTile* GetTile(int x, int y) const {
-		return tiles[y*width + x];
+	GameMapTile* GetTile(int x, int y) {
+		return &tiles[y*width + x];
 	}
 
 	/**
 	* Gets tile at selected position
 	*/
-	GameMapTile* GetTile(Vec2i pos) const {
-		return tiles[pos.y*width + pos.x];
+	GameMapTile* GetTile(Vec2i pos) {
+		return &tiles[pos.y*width + pos.x];
+	}
+
+	/**
+	* Gets tile at selected index
+	*/
+	GameMapTile* GetTileByIndex(int index) {
+		return &tiles[index];
+	}
+
+	/**
+	* Gets index of the tile at selected position
+	*/
+	int GetTileIndex(Vec2i pos) const {
+		return pos.y*width + pos.x;
+	}
+
+	/**
+	* Gets position of the tile at selected index
+	*/
+	Vec2i GetTilePosition(int index) const {
+		return Vec2i(index % width, index / width);
+	}
+
+	/**
+	* Gets index of the neighbor of a tile at selected index
+	* or -1 if the neighbor lies outside the map
+	*/
+	int GetNeighborIndex(int index, int dirX, int dirY) const {
+		int x = index % width + dirX;
+		int y = index / width + dirY;
+		return (x < 0 || y < 0 || x >= width || y >= height) ? -1 : (y*width + x);
+	}
+
+	/**
+	* Gets type of the tile at selected index
+	*/
+	MapTileType GetTileType(int index) const {
+		return tileTypes[index];
+	}
+
+	/**
+	* Gets indicator whether the tile at selected index is walkable
+	*/
+	bool IsWalkable(int index) const {
+		return tileTypes[index] == MapTileType::GROUND || tileTypes[index] == MapTileType::RIG_PLATFORM;
+	}
+
+	/**
+	* Gets indicator whether the tile at selected index is forbidden
+	*/
+	bool IsForbidden(int index) const {
+		return tileForbidden[index] != 0;
+	}
+
+	/**
+	* Gets indicator whether the tile at selected index is occupied
+	*/
+	bool IsOccupied(int index) const {
+		return tileOccupied[index] != 0;
+	}
+
+	/**
+	* Gets indicator whether the tile at selected index can be entered
+	* @param crossForbiddenArea if true, forbidden tiles can be entered as well
+	*/
+	bool IsPassable(int index, bool crossForbiddenArea) const {
+		return IsWalkable(index) && (crossForbiddenArea || tileForbidden[index] == 0);
+	}
+
+	/**
+	* Gets indicator whether the tile at selected coordinates lies inside the map and can be entered
+	* @param crossForbiddenArea if true, forbidden tiles can be entered as well
+	*/
+	bool IsPassable(int x, int y, bool crossForbiddenArea) const {
+		return x >= 0 && y >= 0 && x < width && y < height && IsPassable(y*width + x, crossForbiddenArea);
+	}
+
+	/**
+	* Gets cost of a step from the tile at selected index to its neighbor in given direction,
+	* or -1 if the step isn't possible; diagonal steps can't cut corners of impassable tiles
+	* @param crossForbiddenArea if true, forbidden tiles can be entered with a penalty
+	*/
+	int GetStepCost(int index, int dirX, int dirY, bool crossForbiddenArea) const {
+		int neighbor = GetNeighborIndex(index, dirX, dirY);
+		if (neighbor == -1 || !IsPassable(neighbor, crossForbiddenArea)) return -1;
+
+		int cost = MAP_STEP_COST;
+		if (dirX != 0 && dirY != 0) {
+			if (!IsPassable(index + dirX, crossForbiddenArea) || !IsPassable(index + dirY*width, crossForbiddenArea)) return -1;
+			cost = MAP_DIAGONAL_COST;
+		}
+		return tileForbidden[neighbor] != 0 ? cost + MAP_FORBIDDEN_PENALTY : cost;
+	}
+
+	/**
+	* Calculates lower bound of the cost between two tiles (octile distance)
+	*/
+	int CalcHeuristic(int from, int to) const {
+		int dx = abs(from % width - to % width);
+		int dy = abs(from / width - to / width);
+		return dx > dy ? (MAP_STEP_COST*dx + (MAP_DIAGONAL_COST - MAP_STEP_COST)*dy) 
+			: (MAP_STEP_COST*dy + (MAP_DIAGONAL_COST - MAP_STEP_COST)*dx);
 	}
 
 	/**
@@ -261,12 +547,17 @@ public:
 	vector<Vec2i> GetRigsPositions() const {
 		vector<Vec2i> output;
 		
-		for (auto node : this->rigs) {
-			output.push_back(node->pos);
+		for (auto rig : this->rigs) {
+			output.push_back(GetTilePosition(rig));
 		}
 		return output;
 	}
 
+	/**
+	* Gets positions of platform tiles around rig at selected position
+	*/
+	void GetRigPlatforms(Vec2i rigPosition, vector<Vec2i>& output) const;
+
 	/**
 	* Gets width of the map (in number of tiles)
 	*/
@@ -287,4 +578,82 @@ public:
 	Settings& GetMapConfig() {
 		return this->mapConfig;
 	}
-};
\ No newline at end of file
+
+private:
+
+	/**
+	* Gets key of the planners heading to selected tile
+	*/
+	int GetPathPlannerKey(int goal, bool crossForbiddenArea) const {
+		return goal * 2 + (crossForbiddenArea ? 1 : 0);
+	}
+
+	/**
+	* Unregisters planner that is being destroyed
+	*/
+	void RemovePathPlanner(IncrementalPathPlanner* planner) {
+		auto found = pathPlanners.find(GetPathPlannerKey(planner->GetGoal(), planner->CrossesForbiddenArea()));
+		// the planner isn't used anymore, but a newer planner with the same key might be
+		if (found != pathPlanners.end() && found->second.expired()) pathPlanners.erase(found);
+	}
+
+	friend class GameMapTile;
+	friend class IncrementalPathPlanner;
+	friend class MapBinary;
+};
+
+// ===================================== GameMapTile inline accessors ========================================
+
+inline MapTileType GameMapTile::GetMapTileType() const {
+	return gameMap->tileTypes[index];
+}
+
+inline void GameMapTile::SetMapTileType(MapTileType newType) {
+	gameMap->tileTypes[index] = newType;
+}
+
+inline int GameMapTile::GetMapTileTypeIndex() const {
+	return gameMap->tileIndices[index];
+}
+
+inline void GameMapTile::SetMapTileTypeIndex(int index) {
+	gameMap->tileIndices[this->index] = index;
+}
+
+inline string GameMapTile::GetMapTileName() const {
+	auto type = gameMap->tileTypes[index];
+	return type == MapTileType::NONE ? string() : Helper::GetMapNameByTileType(type);
+}
+
+inline void GameMapTile::SetMapTileName(string name) {
+	gameMap->tileTypes[index] = Helper::GetMapTileTypeByName(name);
+}
+
+inline bool GameMapTile::IsOccupied() const {
+	return gameMap->tileOccupied[index] != 0;
+}
+
+inline void GameMapTile::SetIsOccupied(bool occupied) {
+	gameMap->tileOccupied[index] = occupied;
+}
+
+inline bool GameMapTile::IsForbidden() const {
+	return gameMap->tileForbidden[index] != 0;
+}
+
+inline void GameMapTile::SetIsForbidden(bool forbidden) {
+	gameMap->tileForbidden[index] = forbidden;
+}
+
+inline bool GameMapTile::IsWalkable() const {
+	return gameMap->IsWalkable(index);
+}
+
+inline Vec2i GameMapTile::GetPosition() const {
+	return gameMap->GetTilePosition(index);
+}
+
+inline GameMapTile* GameMapTile::GetNeighbor(int dirX, int dirY) const {
+	int neighbor = gameMap->GetNeighborIndex(index, dirX, dirY);
+	return neighbor == -1 ? nullptr : &gameMap->tiles[neighbor];
+}
@@ -6,9 +6,8 @@
 #include "MsgEvents.h"
 #include "RigBehavior.h"
 #include "StateMachine.h"
-#include "Worker.h"
+#include "WorkerSystem.h"
 #include "GameTask.h"
-#include "Move.h"
 #include "Scene.h"
 #include "Interpolator.h"
 #include "TaskScheduler.h"
@@ -16,6 +15,8 @@
 #include "GameAI.h"
 #include "CompositeBehavior.h"
 #include "ComponentStorage.h"
+#include "PathBenchmark.h"
+#include "SteeringBenchmark.h"
 
 void GameModel::OnInit() {	
 	
@@ -37,8 +38,29 @@ void GameModel::OnInit() {
 	mapConfig.LoadFromXml(xml);
 	xml->popTag();
 
+	auto& settings = CogGetProjectSettings();
+	if (settings.GetSettingValBool("hydroq_set", "map_compile")) {
+		MapBinary::CompileAll(mapConfig);
+	}
+
 	this->hydroqMap->LoadMap(mapConfig, mapName);
+
+	if (settings.GetSettingVal("hydroq_set", "path_search") == "jps") {
+		this->hydroqMap->SetDefaultBackend(PathSearchBackend::JPS);
+	}
+
+	if (settings.GetSettingValBool("hydroq_set", "path_benchmark")) {
+		PathBenchmark::Run(mapConfig);
+	}
+
+	if (settings.GetSettingValBool("hydroq_set", "steering_benchmark")) {
+		SteeringBenchmark::Run(settings.GetSettingValFloat("hydroq_set", "unit_max_acc"), settings.GetSettingValFloat("hydroq_set", "unit_max_radial_acc"));
+	}
+
 	this->cellSpace = new GridSpace<NodeCellObject>(ofVec2f(hydroqMap->GetWidth(), hydroqMap->GetHeight()), 1);
+	this->taskIndex.Init();
+	this->attractorGrid.Init(hydroqMap->GetWidth(), hydroqMap->GetHeight());
+	this->workerSystem.Init(this);
 
 	DivideRigsIntoFactions();
 }
@@ -78,21 +100,19 @@ void GameModel::MarkPositionForBridge(Vec2i position, Faction faction) {
 	auto node = CreateDynamicObject(position, EntityType::BRIDGE_MARK, faction, 0);
 	auto newTask = spt<GameTask>(new GameTask(GameTaskType::BRIDGE_BUILD, faction));
 	newTask->SetTaskNode(node);
-	gameTasks.push_back(newTask);
+	AddGameTask(newTask);
 }
 
 void GameModel::DeleteBridgeMark(Vec2i position) {
 	COGLOGDEBUG("Hydroq", "Deleting bridge mark at [%d, %d]", position.x, position.y);
 	auto obj = dynObjects[position];
 
-	for (auto task : gameTasks) {
-		if (task->GetTaskNode()->GetId() == obj->GetId()) {
-			COGLOGDEBUG("Hydroq", "Aborting building task because of deleted bridge mark");
-			SendMessageToModel(StrId(ACT_TASK_ABORTED), 0, spt<TaskAbortEvent>(new TaskAbortEvent(task)));
-			task->SetIsEnded(true); // for sure
-			RemoveGameTask(task);
-			break;
-		}
+	auto task = taskIndex.FindTaskByNode(obj);
+	if (task) {
+		COGLOGDEBUG("Hydroq", "Aborting building task because of deleted bridge mark");
+		SendMessageToModel(StrId(ACT_TASK_ABORTED), 0, spt<TaskAbortEvent>(new TaskAbortEvent(task)));
+		task->SetIsEnded(true); // for sure
+		RemoveGameTask(task);
 	}
 
 	this->hydroqMap->GetTile(position)->SetIsForbidden(false);
@@ -139,7 +159,7 @@ void GameModel::MarkPositionForDestroy(Vec2i position, Faction faction) {
 	auto node = CreateDynamicObject(position, EntityType::DESTROY_MARK, playerModel->GetFaction(), 0);
 	auto newTask = spt<GameTask>(new GameTask(GameTaskType::BRIDGE_DESTROY, faction));
 	newTask->SetTaskNode(node);
-	gameTasks.push_back(newTask);
+	AddGameTask(newTask);
 	this->hydroqMap->GetTile(position)->SetIsForbidden(true);
 	this->hydroqMap->RefreshTile(position);
 }
@@ -160,6 +180,9 @@ void GameModel::SpawnWorker(ofVec2f position, Faction faction, int identifier, V
 		playerModel->AddUnit(1);
 	}
 
+	SendMessageToModel(StrId(ACT_SCHEDULING_CHANGED), 0,
+		spt<SchedulingChangedEvent>(new SchedulingChangedEvent(SchedulingChangeType::WORKER_SPAWNED, faction)));
+
 	if (playerModel->IsMultiplayer() && identifier == 0) {
 		SendMessageOutside(StrId(ACT_SYNC_OBJECT_CHANGED), 0,
 			spt<SyncEvent>(new SyncEvent(SyncEventType::OBJECT_CREATED, EntityType::WORKER, faction, position, node->GetId(), 0, rigPosition)));
@@ -186,10 +209,13 @@ void GameModel::BuildPlatform(Vec2i position, Faction faction, int identifier) {
 
 	// for all tasks, update their DELAY status; this is because some building tasks are not reachable yet but if some new platform is built,
 	// the situation may be different
-	for (auto& task : gameTasks) {
+	for (auto& task : taskIndex.GetTasks()) {
 		task->SetIsDelayed(false);
 	}
 
+	SendMessageToModel(StrId(ACT_SCHEDULING_CHANGED), 0,
+		spt<SchedulingChangedEvent>(new SchedulingChangedEvent(SchedulingChangeType::PLATFORM_BUILT, faction)));
+
 	if (playerModel->IsMultiplayer() && identifier == 0) {
 		SendMessageOutside(StrId(ACT_SYNC_OBJECT_CHANGED), 0,
 			spt<SyncEvent>(new SyncEvent(SyncEventType::MAP_CHANGED, EntityType::BRIDGE, faction, position, 0, 0, Vec2i(0))));
@@ -211,7 +237,7 @@ void GameModel::DestroyPlatform(Vec2i position, Faction faction, int identifier)
 	hydroqMap->RefreshTile(node);
 
 	// when a platform is destroyed, all path-finding tasks must be recalculated
-	for (auto task : gameTasks) {
+	for (auto& task : taskIndex.GetTasks()) {
 		task->SetNeedRecalculation(true);
 	}
 
@@ -232,12 +258,18 @@ void GameModel::AddAttractor(Vec2i position, Faction faction, float cardinality)
 	auto gameNode = CreateNode(EntityType::ATTRACTOR, position, faction, 0);
 	gameNode->AddAttr(ATTR_CARDINALITY, cardinality);
 	attractors[faction][position] = gameNode;
+	attractorGrid.AddAttractor(faction, gameNode->GetId(), position);
+	RefreshAttractorCardinalities(faction);
 
 	SendMessageOutside(StrId(ACT_MAP_OBJECT_CHANGED), 0,
 		spt<MapObjectChangedEvent>(new MapObjectChangedEvent(ObjectChangeType::ATTRACTOR_CREATED, nullptr, gameNode)));
 	auto newTask = spt<GameTask>(new GameTask(GameTaskType::ATTRACT, faction));
 	newTask->SetTaskNode(gameNode);
-	gameTasks.push_back(newTask);
+	AddGameTask(newTask);
+
+	// the other attractors have got smaller shares
+	SendMessageToModel(StrId(ACT_SCHEDULING_CHANGED), 0,
+		spt<SchedulingChangedEvent>(new SchedulingChangedEvent(SchedulingChangeType::ATTRACTORS_CHANGED, faction)));
 }
 
 void GameModel::DestroyAttractor(Vec2i position, Faction faction) {
@@ -248,19 +280,23 @@ void GameModel::DestroyAttractor(Vec2i position, Faction faction) {
 		CogLogInfo("Hydroq", "Removing attractor at [%d, %d]", position.x, position.y);
 
 		attractors[faction].erase(position);
+		attractorGrid.RemoveAttractor(faction, gameNode->GetId(), position);
+		RefreshAttractorCardinalities(faction);
 
 		SendMessageOutside(StrId(ACT_MAP_OBJECT_CHANGED), 0,
 			spt<MapObjectChangedEvent>(new MapObjectChangedEvent(ObjectChangeType::ATTRACTOR_REMOVED, nullptr, gameNode)));
 
-		for (auto task : gameTasks) {
-			if (task->GetTaskNode()->GetId() == gameNode->GetId()) {
-				COGLOGDEBUG("Hydroq", "Aborting attractor task because of deleted attractor");
-				SendMessageToModel(StrId(ACT_TASK_ABORTED), 0, spt<TaskAbortEvent>(new TaskAbortEvent(task)));
-				task->SetIsEnded(true); // for sure
-				RemoveGameTask(task);
-				break;
-			}
+		auto task = taskIndex.FindTaskByNode(gameNode);
+		if (task) {
+			COGLOGDEBUG("Hydroq", "Aborting attractor task because of deleted attractor");
+			SendMessageToModel(StrId(ACT_TASK_ABORTED), 0, spt<TaskAbortEvent>(new TaskAbortEvent(task)));
+			task->SetIsEnded(true); // for sure
+			RemoveGameTask(task);
 		}
+
+		// the other attractors have got bigger shares
+		SendMessageToModel(StrId(ACT_SCHEDULING_CHANGED), 0,
+			spt<SchedulingChangedEvent>(new SchedulingChangedEvent(SchedulingChangeType::ATTRACTORS_CHANGED, faction)));
 	}
 }
 
@@ -278,21 +314,37 @@ void GameModel::DestroyAllAttractors(Faction faction) {
 void GameModel::ChangeAttractorCardinality(Vec2i position, Faction faction, float cardinality) {
 	auto gameNode = attractors[faction][position];
 	gameNode->ChangeAttr(ATTR_CARDINALITY, cardinality);
+	RefreshAttractorCardinalities(faction);
+
+	// the attractor may need more workers even if all of them have been assigned
+	SendMessageToModel(StrId(ACT_SCHEDULING_CHANGED), 0,
+		spt<SchedulingChangedEvent>(new SchedulingChangedEvent(SchedulingChangeType::ATTRACTORS_CHANGED, faction)));
 }
 
-float GameModel::CalcAttractorAbsCardinality(Faction faction, int attractorId) {
-	
-	float attrCardinality = 0;
+float GameModel::CalcAttractorAbsCardinality(Faction faction, int attractorId) const {
+	auto factionCardinalities = absCardinalities.find(faction);
+	if (factionCardinalities == absCardinalities.end()) {
+		return 0;
+	}
+
+	auto found = factionCardinalities->second.find(attractorId);
+	return found != factionCardinalities->second.end() ? found->second : 0;
+}
+
+void GameModel::RefreshAttractorCardinalities(Faction faction) {
+	auto& factionAttractors = attractors[faction];
+	auto& cardinalities = absCardinalities[faction];
+	cardinalities.clear();
+
 	float cardinalitySum = 0;
-	
-	for (auto& key : attractors[faction]) {
+	for (auto& key : factionAttractors) {
+		cardinalitySum += key.second->GetAttr<float>(ATTR_CARDINALITY);
+	}
+
+	for (auto& key : factionAttractors) {
 		float card = key.second->GetAttr<float>(ATTR_CARDINALITY);
-		if (key.second->GetId() == attractorId) {
-			attrCardinality = card;
-		}
-		cardinalitySum += card;
+		cardinalities[key.second->GetId()] = isEqual(cardinalitySum, card) ? card : card / cardinalitySum;
 	}
-	return isEqual(cardinalitySum, attrCardinality) ? attrCardinality : attrCardinality / cardinalitySum;
 }
 
 void GameModel::ChangeRigOwner(Node* rig, Faction faction) {
@@ -320,11 +372,18 @@ void GameModel::ChangeRigOwner(Node* rig, Faction faction) {
 		for (auto worker : workers) {
 			// change workers faction according to the new rig owner
 			worker->ChangeAttr(ATTR_FACTION, faction);
+			workerSystem.SetFaction(worker, faction);
 			worker->SetTag(faction == Faction::RED ? "worker_red" : "worker_blue");
 			if (oldFaction == playerModel->GetFaction()) playerModel->RemoveUnit(1);
 			else playerModel->AddUnit(1);
 		}
 
+		if (!workers.empty()) {
+			// workers of the rig have joined the new owner
+			SendMessageToModel(StrId(ACT_SCHEDULING_CHANGED), 0,
+				spt<SchedulingChangedEvent>(new SchedulingChangedEvent(SchedulingChangeType::WORKER_SPAWNED, faction)));
+		}
+
 		SendMessageOutside(StrId(ACT_MAP_OBJECT_CHANGED), 0,
 			spt<MapObjectChangedEvent>(new MapObjectChangedEvent(ObjectChangeType::RIG_CAPTURED, nullptr, rig)));
 
@@ -343,7 +402,7 @@ void GameModel::ChangeRigOwner(Node* rig, Faction faction) {
 
 
 void GameModel::GetGameTasksByFaction(Faction faction, vector<spt<GameTask>>& output) {
-	for (auto task : gameTasks) {
+	for (auto& task : taskIndex.GetTasks()) {
 		if (task->GetFaction() == faction) {
 			output.push_back(task);
 		}
@@ -362,9 +421,12 @@ void GameModel::GetMovingObjectsByType(EntityType type, Faction faction, vector<
 }
 
 bool GameModel::RemoveGameTask(spt<GameTask> task) {
-	auto found = find(gameTasks.begin(), gameTasks.end(), task);
-	if (found != gameTasks.end()) {
-		gameTasks.erase(found);
+	if (taskIndex.RemoveTask(task)) {
+		if (!task->GetReservedWorkers().empty()) {
+			// workers of the task are free again
+			SendMessageToModel(StrId(ACT_SCHEDULING_CHANGED), 0,
+				spt<SchedulingChangedEvent>(new SchedulingChangedEvent(SchedulingChangeType::WORKER_FREED, task->GetFaction())));
+		}
 		return true;
 	}
 	else {
@@ -372,6 +434,18 @@ bool GameModel::RemoveGameTask(spt<GameTask> task) {
 	}
 }
 
+void GameModel::CancelGameTaskReservation(spt<GameTask> task, int workerId) {
+	taskIndex.CancelReservation(task, workerId);
+	SendMessageToModel(StrId(ACT_SCHEDULING_CHANGED), 0,
+		spt<SchedulingChangedEvent>(new SchedulingChangedEvent(SchedulingChangeType::WORKER_FREED, task->GetFaction())));
+}
+
+void GameModel::AddGameTask(spt<GameTask> task) {
+	taskIndex.AddTask(task);
+	SendMessageToModel(StrId(ACT_SCHEDULING_CHANGED), 0,
+		spt<SchedulingChangedEvent>(new SchedulingChangedEvent(SchedulingChangeType::TASK_CREATED, task->GetFaction(), task)));
+}
+
 Node* GameModel::FindNearestRigByFaction(Faction fact, ofVec2f startPos) {
 	Node* nearestSoFar = nullptr;
 	ofVec2f nearestPosSoFar = ofVec2f(0);
@@ -417,7 +491,7 @@ void GameModel::Update(const uint64 delta, const uint64 absolute) {
 	vector<spt<GameTask>> tasksForRecalc;
 
 	// push tasks for recalculation so that when update is finished, the indicator will be restarted
-	for (auto task : gameTasks) {
+	for (auto& task : taskIndex.GetTasks()) {
 		if (task->NeedRecalculation()) tasksForRecalc.push_back(task);
 	}
 
@@ -427,6 +501,7 @@ void GameModel::Update(const uint64 delta, const uint64 absolute) {
 
 	rootNode->SubmitChanges(true);
 	rootNode->Update(delta, absolute);
+	workerSystem.Update(delta, absolute);
 
 	this->cellSpace->UpdateObjects();
 
@@ -482,6 +557,10 @@ void GameModel::DestroyDynamicObject(Vec2i position) {
 Node* GameModel::CreateMovingObject(ofVec2f position, EntityType entityType, Faction faction, int identifier) {
 	auto gameNode = CreateNode(EntityType::WORKER, position, faction, identifier);
 	movingObjects.push_back(gameNode);
+	if (identifier == 0) {
+		// workers of other instances are updated by the network interpolator
+		workerSystem.AddWorker(gameNode, faction);
+	}
 	SendMessageOutside(StrId(ACT_MAP_OBJECT_CHANGED), 0, spt<MapObjectChangedEvent>(new MapObjectChangedEvent(ObjectChangeType::MOVING_CREATED, nullptr, gameNode)));
 	return gameNode;
 }
@@ -529,17 +608,6 @@ Node* GameModel::CreateNode(EntityType entityType, ofVec2f position, Faction fac
 		}
 
 		nd->GetTransform().localPos.z = 20;
-
-		if (identifier == 0) {
-			auto nodeBeh = new StateMachine();
-			((StateMachine*)nodeBeh)->ChangeState(new WorkerIdleState(this));
-			((StateMachine*)nodeBeh)->AddLocalState(new WorkerBuildState(this));
-			((StateMachine*)nodeBeh)->AddLocalState(new WorkerAttractState(this));
-
-			nd->AddBehavior(nodeBeh);
-			// add moving behavior
-			nd->AddBehavior(new Move());
-		}
 	}
 
 	nd->GetTransform().localPos.x = position.x;
@@ -615,25 +683,8 @@ void GameModel::DivideRigsIntoFactions() {
 
 		dynObjects[rig] = gameNode;
 		
-		// create platform collection
-		vector<Vec2i> platforms;
-		auto pos = hydMapNode->GetPosition();
-		platforms.push_back(Vec2i(pos.x - 1, pos.y - 1));
-		platforms.push_back(Vec2i(pos.x, pos.y - 1));
-		platforms.push_back(Vec2i(pos.x + 1, pos.y - 1));
-		platforms.push_back(Vec2i(pos.x + 2, pos.y - 1));
-		platforms.push_back(Vec2i(pos.x + 2, pos.y));
-		platforms.push_back(Vec2i(pos.x + 2, pos.y + 1));
-		platforms.push_back(Vec2i(pos.x + 2, pos.y + 2));
-		platforms.push_back(Vec2i(pos.x + 1, pos.y + 2));
-		platforms.push_back(Vec2i(pos.x, pos.y + 2));
-		platforms.push_back(Vec2i(pos.x - 1, pos.y + 2));
-		platforms.push_back(Vec2i(pos.x - 1, pos.y + 1));
-		platforms.push_back(Vec2i(pos.x - 1, pos.y));
-
-		for (auto platformPos : platforms) {
-			rigEntity->platforms.push_back(platformPos);
-		}
+		// platforms are listed by the map
+		hydroqMap->GetRigPlatforms(rig, rigEntity->platforms);
 
 		rigs[rig] = rigEntity;
 		// add entity into game object
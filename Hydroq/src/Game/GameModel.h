@@ -11,6 +11,10 @@
 #include "NodeCellObject.h"
 #include "PlayerModel.h"
 #include "Rig.h"
+#include "GameTaskIndex.h"
+#include "AttractorGrid.h"
+#include "WorkerSystem.h"
+#include <unordered_map>
 
 /**
 * Hydroq game model
@@ -26,8 +30,14 @@ private:
 	map<Vec2i, Node*> dynObjects;
 	// moving objects (workers)
 	vector<Node*> movingObjects;
+	// simulation of workers controlled by this instance
+	WorkerSystem workerSystem;
 	// placed attractors
 	map<Faction, map<Vec2i, Node*>> attractors;
+	// placed attractors partitioned by their positions
+	AttractorGrid attractorGrid;
+	// cardinalities of attractors relative to the sum of all cardinalities of their faction, by attractor id
+	map<Faction, unordered_map<int, float>> absCardinalities;
 	// rig entities
 	map<Vec2i, spt<Rig>> rigs;
 	// game scene that runs separately from the stage
@@ -36,8 +46,8 @@ private:
 	Node* rootNode;
 	// name of selected map
 	string mapName;
-	// list of waiting tasks
-	vector<spt<GameTask>> gameTasks;
+	// waiting tasks, indexed by their handles, nodes and reservations
+	GameTaskIndex taskIndex;
 	// link to player model
 	PlayerModel* playerModel;
 
@@ -190,9 +200,9 @@ public:
 	void ChangeAttractorCardinality(Vec2i position, Faction faction, float cardinality);
 
 	/**
-	* Calculates cardinality of attractor with selected id
+	* Gets cardinality of attractor with selected id, relative to the sum of cardinalities of all attractors of the faction
 	*/
-	float CalcAttractorAbsCardinality(Faction faction, int attractorId);
+	float CalcAttractorAbsCardinality(Faction faction, int attractorId) const;
 
 	/**
 	* Changes owner of a rig
@@ -216,8 +226,15 @@ public:
 	/**
 	* Gets collection of game tasks
 	*/
-	vector<spt<GameTask>>& GetGameTasks() {
-		return this->gameTasks;
+	const vector<spt<GameTask>>& GetGameTasks() const {
+		return taskIndex.GetTasks();
+	}
+
+	/**
+	* Gets game task by its handle or an empty pointer if the task has been removed
+	*/
+	const spt<GameTask>& GetGameTask(TaskHandle handle) const {
+		return taskIndex.GetTask(handle);
 	}
 
 	/**
@@ -256,6 +273,25 @@ public:
 	*/
 	bool RemoveGameTask(spt<GameTask> task);
 
+	/**
+	* Reserves a game task for selected worker
+	*/
+	void ReserveGameTask(spt<GameTask> task, Node* worker) {
+		taskIndex.ReserveTask(task, worker);
+	}
+
+	/**
+	* Removes selected worker from the collection of reservers of a game task
+	*/
+	void CancelGameTaskReservation(spt<GameTask> task, int workerId);
+
+	/**
+	* Gets handles of game tasks reserved for selected worker
+	*/
+	const vector<TaskHandle>& GetReservedGameTasks(int workerId) const {
+		return taskIndex.GetReservedTasks(workerId);
+	}
+
 	/**
 	* Finds nearest rig around selected position by its faction
 	*/
@@ -271,6 +307,15 @@ public:
 	*/
 	void GetAttractorsByFaction(Faction fact, vector<Node*>& output);
 
+	/**
+	* Returns true, if there is an attractor of selected faction closer than the given distance to selected position
+	* @param distance maximal distance, may not be greater than ATTRACTOR_GRID_CELL_SIZE
+	* @param ignoredId id of an attractor that should be ignored
+	*/
+	bool IsNearAttractor(Faction fact, ofVec2f position, float distance, int ignoredId = -1) const {
+		return attractorGrid.IsNearAttractor(fact, position, distance, ignoredId);
+	}
+
 
 	virtual void Update(const uint64 delta, const uint64 absolute);
 
@@ -281,6 +326,16 @@ private:
 	*/
 	bool IsPositionOfType(Vec2i position, EntityType type);
 
+	/**
+	* Recalculates relative cardinalities of all attractors of selected faction
+	*/
+	void RefreshAttractorCardinalities(Faction faction);
+
+	/**
+	* Inserts a new game task
+	*/
+	void AddGameTask(spt<GameTask> task);
+
 	/**
 	* Creates dynamic object at selected position
 	*/
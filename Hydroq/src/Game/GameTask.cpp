@@ -1,18 +1,12 @@
 #include "GameTask.h"
-#include "Node.h"
 
-bool GameTask::IsNodeReserved(int nodeId) {
-	for (auto nd : reservedNodes) {
-		if (nd->GetId() == nodeId) return true;
-	}
-	return false;
+bool GameTask::IsWorkerReserved(int workerId) {
+	return find(reservedWorkers.begin(), reservedWorkers.end(), workerId) != reservedWorkers.end();
 }
 
-void GameTask::RemoveReserverNode(int nodeId) {
-	for (auto it = reservedNodes.begin(); it != reservedNodes.end(); ++it) {
-		if ((*it)->GetId() == nodeId) {
-			reservedNodes.erase(it);
-			break;
-		}
+void GameTask::RemoveReservedWorker(int workerId) {
+	auto found = find(reservedWorkers.begin(), reservedWorkers.end(), workerId);
+	if (found != reservedWorkers.end()) {
+		reservedWorkers.erase(found);
 	}
-}
\ No newline at end of file
+}
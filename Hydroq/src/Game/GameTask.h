@@ -14,6 +14,29 @@ enum class GameTaskType {
 	ATTRACT				/** task for comming to the attractor position */
 };
 
+/**
+* Handle of a game task stored in the model; the handle becomes invalid
+* when the task is removed, even if its slot is reused by another task
+*/
+struct TaskHandle {
+	// index of the slot of the task
+	int slot = -1;
+	// generation of the slot at the time the task was stored
+	unsigned generation = 0;
+
+	TaskHandle() {
+
+	}
+
+	TaskHandle(int slot, unsigned generation) : slot(slot), generation(generation) {
+
+	}
+
+	bool operator==(const TaskHandle& other) const {
+		return slot == other.slot && generation == other.generation;
+	}
+};
+
 /**
 * Crate describing game task to do
 */
@@ -35,12 +58,14 @@ private:
 	bool isDelayed = false;
 	// indicator whether the task has been reserved
 	bool isReserved = false;
-	// collection of nodes that have this task reserved
-	vector<Node*> reservedNodes;
+	// identifiers of workers that have this task reserved
+	vector<int> reservedWorkers;
 	// the time the task was reserved
 	uint64 reservedTime = 0;
 	// faction concerned
 	Faction faction;
+	// handle of the task in the model
+	TaskHandle handle;
 
 public:
 
@@ -161,10 +186,10 @@ public:
 	}
 
 	/**
-	* Gets collection of nodes that have this task reserved
+	* Gets identifiers of workers that have this task reserved
 	*/
-	vector<Node*>& GetReservedNodes() {
-		return this->reservedNodes;
+	vector<int>& GetReservedWorkers() {
+		return this->reservedWorkers;
 	}
 
 	/**
@@ -196,12 +221,26 @@ public:
 	}
 
 	/**
-	* Returns true, if selected node is in the collection of reservers
+	* Gets handle of the task in the model
+	*/
+	TaskHandle GetHandle() const {
+		return handle;
+	}
+
+	/**
+	* Sets handle of the task in the model
+	*/
+	void SetHandle(TaskHandle handle) {
+		this->handle = handle;
+	}
+
+	/**
+	* Returns true, if selected worker is in the collection of reservers
 	*/
-	bool IsNodeReserved(int nodeId);
+	bool IsWorkerReserved(int workerId);
 
 	/**
-	* Removes selected node from the collection of reserved nodes
+	* Removes selected worker from the collection of reservers
 	*/
-	void RemoveReserverNode(int nodeId);
+	void RemoveReservedWorker(int workerId);
 };
\ No newline at end of file
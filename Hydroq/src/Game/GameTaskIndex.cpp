@@ -0,0 +1,105 @@
+#include "GameTaskIndex.h"
+#include "Node.h"
+
+void GameTaskIndex::Init() {
+	slots.clear();
+	freeSlots.clear();
+	tasks.clear();
+	nodeTasks.clear();
+	reservations.clear();
+}
+
+void GameTaskIndex::AddTask(spt<GameTask> task) {
+	int slot;
+	if (!freeSlots.empty()) {
+		slot = freeSlots.back();
+		freeSlots.pop_back();
+	}
+	else {
+		slot = slots.size();
+		slots.push_back(TaskSlot());
+	}
+
+	auto& taskSlot = slots[slot];
+	taskSlot.task = task;
+	taskSlot.denseIndex = tasks.size();
+	tasks.push_back(task);
+
+	TaskHandle handle(slot, taskSlot.generation);
+	task->SetHandle(handle);
+
+	nodeTasks[task->GetTaskNode()->GetId()] = handle;
+
+	// the task may have been reserved before it was stored
+	for (int workerId : task->GetReservedWorkers()) {
+		reservations[workerId].push_back(handle);
+	}
+}
+
+bool GameTaskIndex::RemoveTask(spt<GameTask> task) {
+	TaskHandle handle = task->GetHandle();
+	if (!IsValid(handle) || slots[handle.slot].task != task) {
+		return false;
+	}
+
+	auto& taskSlot = slots[handle.slot];
+
+	// move the last task to the place of the removed one
+	int denseIndex = taskSlot.denseIndex;
+	tasks[denseIndex] = tasks.back();
+	slots[tasks[denseIndex]->GetHandle().slot].denseIndex = denseIndex;
+	tasks.pop_back();
+
+	// invalidate all handles of the slot
+	taskSlot.task = spt<GameTask>();
+	taskSlot.denseIndex = -1;
+	taskSlot.generation++;
+	freeSlots.push_back(handle.slot);
+
+	nodeTasks.erase(task->GetTaskNode()->GetId());
+
+	for (int workerId : task->GetReservedWorkers()) {
+		RemoveHandle(reservations[workerId], handle);
+	}
+
+	task->SetHandle(TaskHandle());
+	return true;
+}
+
+spt<GameTask> GameTaskIndex::FindTaskByNode(Node* taskNode) const {
+	auto found = nodeTasks.find(taskNode->GetId());
+	return found != nodeTasks.end() ? GetTask(found->second) : spt<GameTask>();
+}
+
+void GameTaskIndex::ReserveTask(spt<GameTask> task, Node* worker) {
+	task->GetReservedWorkers().push_back(worker->GetId());
+	task->SetIsReserved(true);
+
+	if (IsValid(task->GetHandle())) {
+		reservations[worker->GetId()].push_back(task->GetHandle());
+	}
+}
+
+void GameTaskIndex::CancelReservation(spt<GameTask> task, int workerId) {
+	task->RemoveReservedWorker(workerId);
+
+	auto found = reservations.find(workerId);
+	if (found != reservations.end()) {
+		RemoveHandle(found->second, task->GetHandle());
+	}
+}
+
+const vector<TaskHandle>& GameTaskIndex::GetReservedTasks(int workerId) const {
+	auto found = reservations.find(workerId);
+	return found != reservations.end() ? found->second : noReservations;
+}
+
+void GameTaskIndex::RemoveHandle(vector<TaskHandle>& handles, TaskHandle handle) {
+	for (int i = 0; i < handles.size(); i++) {
+		if (handles[i] == handle) {
+			handles[i] = handles.back();
+			handles.pop_back();
+			return;
+		}
+	}
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "HydroqDef.h"
+#include "GameTask.h"
+#include "Vec2i.h"
+#include <unordered_map>
+
+using namespace Cog;
+
+/**
+* Storage of game tasks; tasks are kept in a slot map and referred to by generation-checked
+* handles, so that a handle of a removed task never resolves to another task
+* The tasks are further indexed by the id of their task node and by the workers that have them reserved
+* A task is looked up by position through its node: bridge marks and attractors are unique per tile
+* and GameModel keeps them by position
+*/
+class GameTaskIndex {
+private:
+
+	/**
+	* Slot of the slot map
+	*/
+	struct TaskSlot {
+		// stored task, empty if the slot is free
+		spt<GameTask> task;
+		// generation of the slot, incremented when the task is removed
+		unsigned generation = 0;
+		// index of the task in the dense collection of tasks
+		int denseIndex = -1;
+	};
+
+	// slots of the slot map
+	vector<TaskSlot> slots;
+	// indices of free slots
+	vector<int> freeSlots;
+	// all stored tasks in a dense collection (in no particular order)
+	vector<spt<GameTask>> tasks;
+	// handles of tasks by the id of their task node
+	std::unordered_map<int, TaskHandle> nodeTasks;
+	// tasks reserved for each worker (by worker id)
+	std::unordered_map<int, vector<TaskHandle>> reservations;
+	// empty collection returned for workers without reservations
+	vector<TaskHandle> noReservations;
+	// empty task returned for invalid handles
+	spt<GameTask> noTask;
+
+public:
+
+	/**
+	* Removes all tasks from the index
+	*/
+	void Init();
+
+	/**
+	* Stores a new task and assigns a handle to it; the task node must be already set
+	*/
+	void AddTask(spt<GameTask> task);
+
+	/**
+	* Removes a task, including all its reservations
+	* @return true, if the task has been stored
+	*/
+	bool RemoveTask(spt<GameTask> task);
+
+	/**
+	* Returns true, if the handle refers to a stored task
+	*/
+	bool IsValid(TaskHandle handle) const {
+		return handle.slot >= 0 && handle.slot < slots.size() && slots[handle.slot].task
+			&& slots[handle.slot].generation == handle.generation;
+	}
+
+	/**
+	* Gets task by its handle or an empty pointer if the task has been removed
+	*/
+	const spt<GameTask>& GetTask(TaskHandle handle) const {
+		return IsValid(handle) ? slots[handle.slot].task : noTask;
+	}
+
+	/**
+	* Gets collection of all stored tasks
+	*/
+	const vector<spt<GameTask>>& GetTasks() const {
+		return tasks;
+	}
+
+	/**
+	* Finds a task referring to selected node (e.g. a bridge mark or an attractor)
+	* @return found task or an empty pointer
+	*/
+	spt<GameTask> FindTaskByNode(Node* taskNode) const;
+
+	/**
+	* Reserves a task for selected worker
+	*/
+	void ReserveTask(spt<GameTask> task, Node* worker);
+
+	/**
+	* Removes selected worker from the collection of reservers of a task
+	*/
+	void CancelReservation(spt<GameTask> task, int workerId);
+
+	/**
+	* Gets handles of tasks reserved for selected worker
+	*/
+	const vector<TaskHandle>& GetReservedTasks(int workerId) const;
+
+private:
+
+	/**
+	* Removes a handle from a collection, regardless of the order
+	*/
+	void RemoveHandle(vector<TaskHandle>& handles, TaskHandle handle);
+};
@@ -0,0 +1,107 @@
+#include "GapSearch.h"
+#include "GameMap.h"
+
+// offsets of neighbors in 4 directions (bridges are built in 4 directions only)
+static const int gapDirX[] = { 0, 1, 0, -1 };
+static const int gapDirY[] = { -1, 0, 1, 0 };
+
+void GapSearch::Init(GameMap* gameMap) {
+	this->gameMap = gameMap;
+	// the buffers are allocated by the first search
+	stamps.clear();
+	searchStamp = 0;
+}
+
+int GapSearch::GetTileCost(int index) const {
+	return gameMap->GetTileType(index) == MapTileType::WATER ? 1 : 0;
+}
+
+int GapSearch::Search(Vec2i start, Vec2i end, Vec2i& startShore, Vec2i& endShore, int maxIteration) {
+	int sources[] = { gameMap->GetTileIndex(start), gameMap->GetTileIndex(end) };
+
+	int startLabel = gameMap->GetConnectivity().GetLabel(sources[0]);
+
+	if (sources[0] == sources[1] || (startLabel != -1 && startLabel == gameMap->GetConnectivity().GetLabel(sources[1]))) {
+		// the same component -> no bridge is needed
+		startShore = end;
+		endShore = end;
+		return 0;
+	}
+
+	int size = gameMap->GetWidth()*gameMap->GetHeight();
+	if (stamps.size() != size) {
+		stamps.assign(size, 0);
+		distances.assign(size, 0);
+		sides.assign(size, 0);
+		shores.assign(size, -1);
+	}
+
+	searchStamp++;
+	openList.clear();
+
+	for (int side = 0; side < 2; side++) {
+		int source = sources[side];
+		stamps[source] = searchStamp;
+		sides[source] = side;
+		distances[source] = 0;
+		shores[source] = source;
+		openList.push_back(source);
+	}
+
+	int bestGap = -1;
+	int bestShores[2] = { -1, -1 };
+	int iterations = 0;
+
+	while (!openList.empty()) {
+		int actual = openList.front();
+		openList.pop_front();
+
+		int distance = distances[actual];
+		// no edge from this tile on can give a shorter gap
+		if (bestGap != -1 && distance >= bestGap) break;
+
+		if (maxIteration != 0 && iterations++ >= maxIteration) break;
+
+		int side = sides[actual];
+
+		for (int i = 0; i < 4; i++) {
+			int neighbor = gameMap->GetNeighborIndex(actual, gapDirX[i], gapDirY[i]);
+			if (neighbor == -1) continue;
+
+			int cost = GetTileCost(neighbor);
+			int newDistance = distance + cost;
+
+			if (stamps[neighbor] == searchStamp) {
+				if (sides[neighbor] != side) {
+					// the frontiers meet
+					int gap = distance + distances[neighbor];
+					if (bestGap == -1 || gap < bestGap) {
+						bestGap = gap;
+						bestShores[side] = shores[actual];
+						bestShores[1 - side] = shores[neighbor];
+					}
+				}
+
+				// the tile may still be claimed by a shorter way
+				if (newDistance >= distances[neighbor]) continue;
+			}
+
+			stamps[neighbor] = searchStamp;
+			sides[neighbor] = side;
+			distances[neighbor] = newDistance;
+			// the shore is the last tile reachable without bridges
+			shores[neighbor] = newDistance == 0 ? neighbor : (distance == 0 ? actual : shores[actual]);
+
+			if (cost == 0) openList.push_front(neighbor);
+			else openList.push_back(neighbor);
+		}
+	}
+
+	if (bestGap == -1) {
+		return -1;
+	}
+
+	startShore = gameMap->GetTilePosition(bestShores[0]);
+	endShore = gameMap->GetTilePosition(bestShores[1]);
+	return bestGap;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Vec2i.h"
+#include <deque>
+
+using namespace Cog;
+
+class GameMap;
+
+/**
+* Bidirectional search for the shortest water gap between two positions
+* Both positions are expanded at once over 4 directions, entering water costs one bridge
+* and entering any other tile is free; the frontiers claim tiles and the cheapest edge
+* between tiles claimed by different sides gives the gap and the shores on both sides
+*/
+class GapSearch {
+private:
+	// link to the map
+	GameMap* gameMap = nullptr;
+	// stamp of the actual search
+	int searchStamp = 0;
+	// stamp of the search that has reached each tile
+	vector<int> stamps;
+	// number of water tiles on the way from the side that has claimed the tile
+	vector<int> distances;
+	// side that has claimed the tile (0 for start, 1 for end)
+	vector<unsigned char> sides;
+	// the last tile reachable without bridges on the way to each tile
+	vector<int> shores;
+	// open list of the 0-1 search
+	std::deque<int> openList;
+
+public:
+
+	/**
+	* Binds the search to a map; the buffers are allocated by the first search
+	*/
+	void Init(GameMap* gameMap);
+
+	/**
+	* Finds the shortest water gap between tiles reachable from start and tiles reachable from end
+	* @param startShore output tile on the start side where the bridge should begin
+	* @param endShore output tile on the end side where the bridge should end
+	* @param maxIteration maximal number of expanded tiles (0 for infinite)
+	* @return number of water tiles to bridge (0 if end can be reached), -1 if no gap has been found
+	*/
+	int Search(Vec2i start, Vec2i end, Vec2i& startShore, Vec2i& endShore, int maxIteration);
+
+private:
+
+	/**
+	* Gets cost of entering selected tile (1 for water, 0 otherwise)
+	*/
+	int GetTileCost(int index) const;
+};
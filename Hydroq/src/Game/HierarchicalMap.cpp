@@ -0,0 +1,378 @@
+#include "HierarchicalMap.h"
+#include "GameMap.h"
+#include <queue>
+
+// offsets of neighbors in 8 directions
+static const int hpaDirX[] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+static const int hpaDirY[] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+
+// maximal length of a run of free border tiles served by a single transition
+#define HPA_MAX_SINGLE_TRANSITION 6
+
+void HierarchicalMap::Init(GameMap* gameMap) {
+	this->gameMap = gameMap;
+	clustersX = (gameMap->GetWidth() + clusterSize - 1) / clusterSize;
+	clustersY = (gameMap->GetHeight() + clusterSize - 1) / clusterSize;
+
+	int clustersNum = clustersX*clustersY;
+	clusters.assign(clustersNum, HierarchicalCluster());
+	verticalBorders.assign(clustersNum, vector<pair<int, int>>());
+	horizontalBorders.assign(clustersNum, vector<pair<int, int>>());
+	clusterDirty.assign(clustersNum, false);
+	dirtyClusters.clear();
+
+	int area = clusterSize*clusterSize;
+	localDist.resize(area);
+	localParents.resize(area);
+	startDist.resize(area);
+	endDist.resize(area);
+
+	for (int i = 0; i < clustersNum; i++) {
+		RecalcBorders(i);
+	}
+
+	for (int i = 0; i < clustersNum; i++) {
+		RecalcCluster(i);
+	}
+}
+
+void HierarchicalMap::OnTileChanged(int index) {
+	int cluster = GetClusterOfTile(index);
+	if (!clusterDirty[cluster]) {
+		clusterDirty[cluster] = true;
+		dirtyClusters.push_back(cluster);
+	}
+}
+
+int HierarchicalMap::FindAbstractPath(Vec2i start, Vec2i end, vector<Vec2i>& output) {
+	RefreshDirtyClusters();
+
+	int startTile = gameMap->GetTileIndex(start);
+	int endTile = gameMap->GetTileIndex(end);
+	int startCluster = GetClusterOfTile(startTile);
+	int endCluster = GetClusterOfTile(endTile);
+
+	if (!gameMap->IsWalkable(endTile)) return -1;
+
+	// connect start and end to the entrances of their clusters
+	SearchInCluster(startTile, startCluster, startDist, localParents);
+	SearchInCluster(endTile, endCluster, endDist, localParents);
+
+	unordered_map<int, int> costs;
+	unordered_map<int, int> cameFrom;
+	priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> openList;
+
+	costs[startTile] = 0;
+	openList.push(make_pair(gameMap->CalcHeuristic(startTile, endTile), startTile));
+
+	// relaxes edge between two abstract nodes
+	auto relax = [&](int from, int to, int cost) {
+		int newCost = costs[from] + cost;
+		auto found = costs.find(to);
+		if (found == costs.end() || newCost < found->second) {
+			costs[to] = newCost;
+			cameFrom[to] = from;
+			openList.push(make_pair(newCost + gameMap->CalcHeuristic(to, endTile), to));
+		}
+	};
+
+	while (!openList.empty()) {
+		auto top = openList.top();
+		openList.pop();
+		int actual = top.second;
+		int actualCost = costs[actual];
+
+		// outdated item
+		if (top.first > actualCost + gameMap->CalcHeuristic(actual, endTile)) continue;
+
+		if (actual == endTile) {
+			// reconstruct the path
+			vector<Vec2i> reversed;
+			for (int tile = endTile; tile != startTile; tile = cameFrom[tile]) {
+				reversed.push_back(gameMap->GetTilePosition(tile));
+			}
+			reversed.push_back(start);
+			output.insert(output.end(), reversed.rbegin(), reversed.rend());
+			return actualCost;
+		}
+
+		if (actual == startTile) {
+			auto& cluster = clusters[startCluster];
+			for (int i = 0; i < cluster.entrances.size(); i++) {
+				int dist = startDist[GetLocalIndex(cluster.entrances[i], startCluster)];
+				if (dist < MAP_INFINITE_COST) relax(actual, cluster.entrances[i], dist);
+			}
+			if (startCluster == endCluster) {
+				int dist = startDist[GetLocalIndex(endTile, endCluster)];
+				if (dist < MAP_INFINITE_COST) relax(actual, endTile, dist);
+			}
+		}
+
+		int actualCluster = GetClusterOfTile(actual);
+		int entrance = FindEntrance(actual, actualCluster);
+
+		if (entrance != -1) {
+			auto& cluster = clusters[actualCluster];
+			int entrancesNum = cluster.entrances.size();
+
+			// edges inside the cluster
+			for (int i = 0; i < entrancesNum; i++) {
+				int dist = cluster.distances[entrance*entrancesNum + i];
+				if (i != entrance && dist < MAP_INFINITE_COST) relax(actual, cluster.entrances[i], dist);
+			}
+
+			// edges across the borders
+			for (int partner : cluster.partners[entrance]) {
+				Vec2i from = gameMap->GetTilePosition(actual);
+				Vec2i to = gameMap->GetTilePosition(partner);
+				int cost = gameMap->GetStepCost(actual, to.x - from.x, to.y - from.y, true);
+				if (cost != -1) relax(actual, partner, cost);
+			}
+
+			// edge to the end; the search ran from the end, so the penalties of both endpoints are swapped
+			if (actualCluster == endCluster) {
+				int dist = endDist[GetLocalIndex(actual, endCluster)];
+				if (dist < MAP_INFINITE_COST) {
+					dist += (gameMap->IsForbidden(endTile) ? MAP_FORBIDDEN_PENALTY : 0) - (gameMap->IsForbidden(actual) ? MAP_FORBIDDEN_PENALTY : 0);
+					relax(actual, endTile, dist);
+				}
+			}
+		}
+	}
+
+	return -1;
+}
+
+void HierarchicalMap::RefinePath(vector<Vec2i>& abstractPath, vector<Vec2i>& output) {
+	if (abstractPath.empty()) return;
+
+	output.push_back(abstractPath[0]);
+
+	for (int i = 1; i < abstractPath.size(); i++) {
+		if (!RefineSegment(abstractPath[i - 1], abstractPath[i], output)) {
+			output.clear();
+			return;
+		}
+	}
+}
+
+bool HierarchicalMap::RefineSegment(Vec2i from, Vec2i to, vector<Vec2i>& output) {
+	if (from == to) return true;
+
+	int fromTile = gameMap->GetTileIndex(from);
+	int toTile = gameMap->GetTileIndex(to);
+	int cluster = GetClusterOfTile(fromTile);
+
+	if (cluster != GetClusterOfTile(toTile)) {
+		// transition across the border -> only one step
+		output.push_back(to);
+		return true;
+	}
+
+	SearchInCluster(fromTile, cluster, localDist, localParents);
+
+	int toLocal = GetLocalIndex(toTile, cluster);
+	if (localDist[toLocal] >= MAP_INFINITE_COST) return false;
+
+	// go back from the end
+	int cx = (cluster % clustersX)*clusterSize;
+	int cy = (cluster / clustersX)*clusterSize;
+	int offset = output.size();
+
+	for (int local = toLocal; localParents[local] != -1; local = localParents[local]) {
+		output.push_back(Vec2i(cx + local % clusterSize, cy + local / clusterSize));
+	}
+
+	reverse(output.begin() + offset, output.end());
+	return true;
+}
+
+int HierarchicalMap::GetClusterOfTile(int index) const {
+	int width = gameMap->GetWidth();
+	return ((index / width) / clusterSize)*clustersX + (index % width) / clusterSize;
+}
+
+void HierarchicalMap::RecalcBorders(int cluster) {
+	int width = gameMap->GetWidth();
+	int height = gameMap->GetHeight();
+	int cx = cluster % clustersX;
+	int cy = cluster / clustersX;
+	int x0 = cx*clusterSize;
+	int y0 = cy*clusterSize;
+	int x1 = min(width, x0 + clusterSize);
+	int y1 = min(height, y0 + clusterSize);
+
+	// right border
+	if (cx < clustersX - 1) {
+		verticalBorders[cluster].clear();
+		CalcTransitions(y0*width + x1 - 1, width, 1, y1 - y0, verticalBorders[cluster]);
+	}
+	// left border
+	if (cx > 0) {
+		verticalBorders[cluster - 1].clear();
+		CalcTransitions(y0*width + x0 - 1, width, 1, y1 - y0, verticalBorders[cluster - 1]);
+	}
+	// bottom border
+	if (cy < clustersY - 1) {
+		horizontalBorders[cluster].clear();
+		CalcTransitions((y1 - 1)*width + x0, 1, width, x1 - x0, horizontalBorders[cluster]);
+	}
+	// top border
+	if (cy > 0) {
+		horizontalBorders[cluster - clustersX].clear();
+		CalcTransitions((y0 - 1)*width + x0, 1, width, x1 - x0, horizontalBorders[cluster - clustersX]);
+	}
+}
+
+void HierarchicalMap::CalcTransitions(int first, int step, int cross, int length, vector<pair<int, int>>& output) {
+	int runStart = -1;
+
+	for (int i = 0; i <= length; i++) {
+		int tile = first + i*step;
+		bool free = i < length && gameMap->IsWalkable(tile) && gameMap->IsWalkable(tile + cross);
+
+		if (free && runStart == -1) {
+			runStart = i;
+		}
+		else if (!free && runStart != -1) {
+			int runEnd = i - 1;
+			if (runEnd - runStart + 1 < HPA_MAX_SINGLE_TRANSITION) {
+				// one transition in the middle
+				int middle = first + ((runStart + runEnd) / 2)*step;
+				output.push_back(make_pair(middle, middle + cross));
+			}
+			else {
+				// two transitions at both ends
+				int startTile = first + runStart*step;
+				int endTile = first + runEnd*step;
+				output.push_back(make_pair(startTile, startTile + cross));
+				output.push_back(make_pair(endTile, endTile + cross));
+			}
+			runStart = -1;
+		}
+	}
+}
+
+void HierarchicalMap::RecalcCluster(int cluster) {
+	auto& cl = clusters[cluster];
+	cl.entrances.clear();
+	cl.partners.clear();
+
+	int cx = cluster % clustersX;
+	int cy = cluster / clustersX;
+
+	// adds entrance together with the tile on the other side
+	auto addEntrance = [&](int tile, int partner) {
+		int entrance = FindEntrance(tile, cluster);
+		if (entrance == -1) {
+			cl.entrances.push_back(tile);
+			cl.partners.push_back(vector<int>());
+			entrance = cl.entrances.size() - 1;
+		}
+		cl.partners[entrance].push_back(partner);
+	};
+
+	if (cx < clustersX - 1) for (auto& tr : verticalBorders[cluster]) addEntrance(tr.first, tr.second);
+	if (cx > 0) for (auto& tr : verticalBorders[cluster - 1]) addEntrance(tr.second, tr.first);
+	if (cy < clustersY - 1) for (auto& tr : horizontalBorders[cluster]) addEntrance(tr.first, tr.second);
+	if (cy > 0) for (auto& tr : horizontalBorders[cluster - clustersX]) addEntrance(tr.second, tr.first);
+
+	// costs between entrances
+	int entrancesNum = cl.entrances.size();
+	cl.distances.assign(entrancesNum*entrancesNum, MAP_INFINITE_COST);
+
+	for (int i = 0; i < entrancesNum; i++) {
+		SearchInCluster(cl.entrances[i], cluster, localDist, localParents);
+		for (int j = 0; j < entrancesNum; j++) {
+			cl.distances[i*entrancesNum + j] = localDist[GetLocalIndex(cl.entrances[j], cluster)];
+		}
+	}
+}
+
+void HierarchicalMap::RefreshDirtyClusters() {
+	if (dirtyClusters.empty()) return;
+
+	// borders of dirty clusters affect entrances of their neighbors, if the transitions have changed
+	vector<int> toRecalc;
+	for (int cluster : dirtyClusters) {
+		int cx = cluster % clustersX;
+		int cy = cluster / clustersX;
+		auto left = cx > 0 ? verticalBorders[cluster - 1] : vector<pair<int, int>>();
+		auto right = verticalBorders[cluster];
+		auto top = cy > 0 ? horizontalBorders[cluster - clustersX] : vector<pair<int, int>>();
+		auto bottom = horizontalBorders[cluster];
+
+		RecalcBorders(cluster);
+		toRecalc.push_back(cluster);
+
+		if (cx > 0 && left != verticalBorders[cluster - 1]) toRecalc.push_back(cluster - 1);
+		if (cx < clustersX - 1 && right != verticalBorders[cluster]) toRecalc.push_back(cluster + 1);
+		if (cy > 0 && top != horizontalBorders[cluster - clustersX]) toRecalc.push_back(cluster - clustersX);
+		if (cy < clustersY - 1 && bottom != horizontalBorders[cluster]) toRecalc.push_back(cluster + clustersX);
+		clusterDirty[cluster] = false;
+	}
+	dirtyClusters.clear();
+
+	sort(toRecalc.begin(), toRecalc.end());
+	toRecalc.erase(unique(toRecalc.begin(), toRecalc.end()), toRecalc.end());
+
+	for (int cluster : toRecalc) {
+		RecalcCluster(cluster);
+	}
+}
+
+void HierarchicalMap::SearchInCluster(int from, int cluster, vector<int>& dist, vector<int>& parents) {
+	int width = gameMap->GetWidth();
+	int x0 = (cluster % clustersX)*clusterSize;
+	int y0 = (cluster / clustersX)*clusterSize;
+	int x1 = min(width, x0 + clusterSize);
+	int y1 = min(gameMap->GetHeight(), y0 + clusterSize);
+
+	fill(dist.begin(), dist.end(), MAP_INFINITE_COST);
+	fill(parents.begin(), parents.end(), -1);
+
+	priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> openList;
+	dist[GetLocalIndex(from, cluster)] = 0;
+	openList.push(make_pair(0, from));
+
+	while (!openList.empty()) {
+		auto top = openList.top();
+		openList.pop();
+		int actual = top.second;
+		int actualLocal = GetLocalIndex(actual, cluster);
+		if (top.first > dist[actualLocal]) continue;
+
+		for (int i = 0; i < 8; i++) {
+			int neighbor = gameMap->GetNeighborIndex(actual, hpaDirX[i], hpaDirY[i]);
+			if (neighbor == -1) continue;
+			int nx = neighbor % width;
+			int ny = neighbor / width;
+			if (nx < x0 || ny < y0 || nx >= x1 || ny >= y1) continue;
+
+			int cost = gameMap->GetStepCost(actual, hpaDirX[i], hpaDirY[i], true);
+			if (cost == -1) continue;
+
+			int neighborLocal = GetLocalIndex(neighbor, cluster);
+			if (top.first + cost < dist[neighborLocal]) {
+				dist[neighborLocal] = top.first + cost;
+				parents[neighborLocal] = actualLocal;
+				openList.push(make_pair(dist[neighborLocal], neighbor));
+			}
+		}
+	}
+}
+
+int HierarchicalMap::GetLocalIndex(int index, int cluster) const {
+	int width = gameMap->GetWidth();
+	int x0 = (cluster % clustersX)*clusterSize;
+	int y0 = (cluster / clustersX)*clusterSize;
+	return (index / width - y0)*clusterSize + (index % width - x0);
+}
+
+int HierarchicalMap::FindEntrance(int index, int cluster) const {
+	auto& entrances = clusters[cluster].entrances;
+	for (int i = 0; i < entrances.size(); i++) {
+		if (entrances[i] == index) return i;
+	}
+	return -1;
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "Vec2i.h"
+
+using namespace Cog;
+
+class GameMap;
+
+// default size of a cluster of the hierarchical map (in number of tiles)
+#define HPA_CLUSTER_SIZE 10
+
+/**
+* Cluster of the hierarchical map
+*/
+struct HierarchicalCluster {
+	// tiles that serve as entrances to the cluster
+	vector<int> entrances;
+	// tiles on the other side of the border, for each entrance
+	vector<vector<int>> partners;
+	// costs between all entrances inside the cluster (row-major, entrances.size()^2)
+	vector<int> distances;
+};
+
+/**
+* Abstract graph over the game map (HPA*); the map is divided into clusters that are connected
+* via entrances on their borders, and the costs between entrances of each cluster are precalculated,
+* so that a long path is searched over a few hundred entrances instead of thousands of tiles
+* Only walkable tiles are considered (forbidden tiles are crossed with a penalty)
+*/
+class HierarchicalMap {
+private:
+	// link to the map
+	GameMap* gameMap = nullptr;
+	// size of a cluster (in number of tiles)
+	int clusterSize;
+	// number of clusters in horizontal direction
+	int clustersX = 0;
+	// number of clusters in vertical direction
+	int clustersY = 0;
+	// collection of all clusters
+	vector<HierarchicalCluster> clusters;
+	// transitions across the border between cluster and its right neighbor (pairs of left and right tile)
+	vector<vector<pair<int, int>>> verticalBorders;
+	// transitions across the border between cluster and its bottom neighbor (pairs of top and bottom tile)
+	vector<vector<pair<int, int>>> horizontalBorders;
+	// clusters whose tiles have changed since the last query
+	vector<int> dirtyClusters;
+	// indicator for each cluster whether it is in the dirty collection
+	vector<bool> clusterDirty;
+	// reusable buffers for searches inside one cluster
+	vector<int> localDist;
+	vector<int> localParents;
+	vector<int> startDist;
+	vector<int> endDist;
+
+public:
+
+	HierarchicalMap(int clusterSize = HPA_CLUSTER_SIZE) : clusterSize(clusterSize) {
+
+	}
+
+	/**
+	* Builds the whole abstract graph
+	*/
+	void Init(GameMap* gameMap);
+
+	/**
+	* Gets size of a cluster (in number of tiles)
+	*/
+	int GetClusterSize() const {
+		return clusterSize;
+	}
+
+	/**
+	* Marks the cluster containing selected tile for rebuild
+	*/
+	void OnTileChanged(int index);
+
+	/**
+	* Finds abstract path (start, entrances in between, end)
+	* @param start start position
+	* @param end final position
+	* @param output output collection of abstract waypoints
+	* @return cost of the path or -1 if there is no path
+	*/
+	int FindAbstractPath(Vec2i start, Vec2i end, vector<Vec2i>& output);
+
+	/**
+	* Refines abstract path into the tile-by-tile path; each segment is searched inside one cluster only
+	* @param abstractPath path calculated by FindAbstractPath
+	* @param output output collection of steps
+	*/
+	void RefinePath(vector<Vec2i>& abstractPath, vector<Vec2i>& output);
+
+	/**
+	* Refines one segment of the abstract path (two successive waypoints)
+	* @param output output collection the steps will be appended to (the first waypoint excluded)
+	* @return true, if the segment could be refined
+	*/
+	bool RefineSegment(Vec2i from, Vec2i to, vector<Vec2i>& output);
+
+private:
+
+	/**
+	* Gets cluster id of selected tile
+	*/
+	int GetClusterOfTile(int index) const;
+
+	/**
+	* Recalculates transitions on all borders of selected cluster
+	*/
+	void RecalcBorders(int cluster);
+
+	/**
+	* Finds transitions on one border
+	* @param first first tile on the border, inside the left/top cluster
+	* @param step offset between two successive tiles along the border
+	* @param cross offset between the tile and its neighbor across the border
+	* @param length length of the border
+	* @param output output collection of transitions
+	*/
+	void CalcTransitions(int first, int step, int cross, int length, vector<pair<int, int>>& output);
+
+	/**
+	* Collects entrances of selected cluster and recalculates costs between them
+	*/
+	void RecalcCluster(int cluster);
+
+	/**
+	* Rebuilds all dirty clusters
+	*/
+	void RefreshDirtyClusters();
+
+	/**
+	* Runs Dijkstra search limited to one cluster
+	* @param from start tile
+	* @param cluster cluster the search is limited to
+	* @param dist output distances, indexed by local index of tiles in the cluster
+	* @param parents output local index of the previous tile on the path (or -1)
+	*/
+	void SearchInCluster(int from, int cluster, vector<int>& dist, vector<int>& parents);
+
+	/**
+	* Gets local index of a tile inside its cluster
+	*/
+	int GetLocalIndex(int index, int cluster) const;
+
+	/**
+	* Gets local index of an entrance of the cluster or -1 if the tile isn't an entrance
+	*/
+	int FindEntrance(int index, int cluster) const;
+};
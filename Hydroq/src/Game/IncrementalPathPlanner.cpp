@@ -0,0 +1,209 @@
+#include "IncrementalPathPlanner.h"
+#include "GameMap.h"
+
+// offsets of neighbors in 8 directions
+static const int plannerDirX[] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+static const int plannerDirY[] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+
+IncrementalPathPlanner::IncrementalPathPlanner(GameMap* gameMap, Vec2i start, Vec2i goal, bool crossForbiddenArea)
+	: gameMap(gameMap), crossForbiddenArea(crossForbiddenArea) {
+
+	this->start = gameMap->GetTileIndex(start);
+	this->goal = gameMap->GetTileIndex(goal);
+	this->lastStart = this->start;
+	minX = maxX = goal.x;
+	minY = maxY = goal.y;
+
+	// the search starts at the goal
+	SetRhs(this->goal, 0);
+	Key key = CalcKey(this->goal);
+	openKeys[this->goal] = key;
+	openList.push(OpenItem(key, this->goal));
+}
+
+IncrementalPathPlanner::~IncrementalPathPlanner() {
+	gameMap->RemovePathPlanner(this);
+}
+
+void IncrementalPathPlanner::SetStart(Vec2i start) {
+	int newStart = gameMap->GetTileIndex(start);
+	if (newStart != this->start) {
+		// keys in the open list are now lower bounds only; km keeps them comparable
+		km += gameMap->CalcHeuristic(lastStart, newStart);
+		lastStart = newStart;
+		this->start = newStart;
+	}
+}
+
+bool IncrementalPathPlanner::CalcPath(vector<Vec2i>& output, int maxIteration) {
+
+	// repair the search around tiles that have been changed
+	for (int changed : changedTiles) {
+		UpdateVertex(changed);
+		for (int i = 0; i < 8; i++) {
+			int neighbor = gameMap->GetNeighborIndex(changed, plannerDirX[i], plannerDirY[i]);
+			if (neighbor != -1) UpdateVertex(neighbor);
+		}
+	}
+	changedTiles.clear();
+
+	if (!ComputeShortestPath(maxIteration) || GetG(start) >= MAP_INFINITE_COST) {
+		return false;
+	}
+
+	// follow the cheapest successors from start to goal
+	int actual = start;
+	int maxSteps = gameMap->GetWidth()*gameMap->GetHeight();
+	int offset = output.size();
+	output.push_back(gameMap->GetTilePosition(actual));
+
+	while (actual != goal && maxSteps-- > 0) {
+		int bestCost = MAP_INFINITE_COST;
+		int bestNeighbor = -1;
+
+		for (int i = 0; i < 8; i++) {
+			int cost = gameMap->GetStepCost(actual, plannerDirX[i], plannerDirY[i], crossForbiddenArea);
+			if (cost != -1) {
+				int neighbor = gameMap->GetNeighborIndex(actual, plannerDirX[i], plannerDirY[i]);
+				int total = cost + GetG(neighbor);
+				if (total < bestCost) {
+					bestCost = total;
+					bestNeighbor = neighbor;
+				}
+			}
+		}
+
+		if (bestNeighbor == -1) {
+			output.resize(offset);
+			return false;
+		}
+
+		actual = bestNeighbor;
+		output.push_back(gameMap->GetTilePosition(actual));
+	}
+
+	return actual == goal;
+}
+
+void IncrementalPathPlanner::OnTileChanged(int index) {
+	// a tile can affect the search only if the tile or its neighbor has been reached
+	Vec2i position = gameMap->GetTilePosition(index);
+	if (position.x < minX - 1 || position.x > maxX + 1 || position.y < minY - 1 || position.y > maxY + 1) {
+		return;
+	}
+
+	changedTiles.push_back(index);
+}
+
+int IncrementalPathPlanner::GetG(int index) const {
+	auto found = g.find(index);
+	return found == g.end() ? MAP_INFINITE_COST : found->second;
+}
+
+int IncrementalPathPlanner::GetRhs(int index) const {
+	auto found = rhs.find(index);
+	return found == rhs.end() ? MAP_INFINITE_COST : found->second;
+}
+
+void IncrementalPathPlanner::SetRhs(int index, int value) {
+	rhs[index] = value;
+
+	Vec2i position = gameMap->GetTilePosition(index);
+	minX = min(minX, position.x);
+	maxX = max(maxX, position.x);
+	minY = min(minY, position.y);
+	maxY = max(maxY, position.y);
+}
+
+IncrementalPathPlanner::Key IncrementalPathPlanner::CalcKey(int index) const {
+	int minVal = min(GetG(index), GetRhs(index));
+	if (minVal >= MAP_INFINITE_COST) return Key(MAP_INFINITE_COST, MAP_INFINITE_COST);
+	return Key(minVal + gameMap->CalcHeuristic(start, index) + km, minVal);
+}
+
+void IncrementalPathPlanner::UpdateVertex(int index) {
+	if (index != goal) {
+		// rhs = min(cost(index, succ) + g(succ))
+		int minRhs = MAP_INFINITE_COST;
+		for (int i = 0; i < 8; i++) {
+			int cost = gameMap->GetStepCost(index, plannerDirX[i], plannerDirY[i], crossForbiddenArea);
+			if (cost != -1) {
+				int neighbor = gameMap->GetNeighborIndex(index, plannerDirX[i], plannerDirY[i]);
+				minRhs = min(minRhs, cost + GetG(neighbor));
+			}
+		}
+
+		if (minRhs >= MAP_INFINITE_COST) rhs.erase(index);
+		else SetRhs(index, minRhs);
+	}
+
+	if (GetG(index) != GetRhs(index)) {
+		// (re)insert; the previous item, if any, becomes outdated
+		Key key = CalcKey(index);
+		openKeys[index] = key;
+		openList.push(OpenItem(key, index));
+	}
+	else {
+		openKeys.erase(index);
+	}
+}
+
+IncrementalPathPlanner::Key IncrementalPathPlanner::GetTopKey() {
+	// drop outdated items
+	while (!openList.empty()) {
+		auto& top = openList.top();
+		auto found = openKeys.find(top.second);
+		if (found != openKeys.end() && found->second == top.first) return top.first;
+		openList.pop();
+	}
+	return Key(MAP_INFINITE_COST, MAP_INFINITE_COST);
+}
+
+bool IncrementalPathPlanner::ComputeShortestPath(int maxIteration) {
+	int iterations = 0;
+
+	while (GetTopKey() < CalcKey(start) || GetRhs(start) != GetG(start)) {
+		if (openList.empty()) {
+			// the start can't be reached
+			return true;
+		}
+
+		if (maxIteration != 0 && iterations++ >= maxIteration) {
+			return false;
+		}
+
+		Key oldKey = openList.top().first;
+		int actual = openList.top().second;
+		Key newKey = CalcKey(actual);
+
+		if (oldKey < newKey) {
+			// the key was calculated for an older start
+			openKeys[actual] = newKey;
+			openList.push(OpenItem(newKey, actual));
+			continue;
+		}
+
+		openList.pop();
+		openKeys.erase(actual);
+
+		int actualG = GetG(actual);
+		int actualRhs = GetRhs(actual);
+
+		if (actualG > actualRhs) {
+			// overconsistent -> settle
+			g[actual] = actualRhs;
+		}
+		else {
+			// underconsistent -> invalidate and propagate
+			g.erase(actual);
+			UpdateVertex(actual);
+		}
+
+		for (int i = 0; i < 8; i++) {
+			int neighbor = gameMap->GetNeighborIndex(actual, plannerDirX[i], plannerDirY[i]);
+			if (neighbor != -1) UpdateVertex(neighbor);
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "Vec2i.h"
+#include <queue>
+
+using namespace Cog;
+
+class GameMap;
+
+/**
+* Incremental path planner (D* Lite) between a moving start and a fixed goal
+* The search runs from the goal towards the start so that the explored area
+* stays valid when the unit moves; tile changes reported by GameMap::RefreshTile
+* repair only the affected part of the search instead of running it again
+* The planner is shared by all units heading to the same goal (see GameMap::GetPathPlanner);
+* each of them sets its own start before the calculation
+*/
+class IncrementalPathPlanner {
+private:
+	// priority of a node in the open list
+	typedef pair<int, int> Key;
+	// item of the open list (lazily removed, see openKeys)
+	typedef pair<Key, int> OpenItem;
+
+	// link to the map
+	GameMap* gameMap;
+	// index of the start tile
+	int start;
+	// index of the goal tile
+	int goal;
+	// start tile used when the last key modifier was calculated
+	int lastStart;
+	// key modifier, accumulated when the start moves
+	int km = 0;
+	// if true, forbidden tiles may be crossed (with a penalty)
+	bool crossForbiddenArea;
+	// cost-to-goal estimates from the last expansion
+	unordered_map<int, int> g;
+	// one-step lookahead cost-to-goal values
+	unordered_map<int, int> rhs;
+	// open list, sorted by keys (the smallest at the top)
+	priority_queue<OpenItem, vector<OpenItem>, greater<OpenItem>> openList;
+	// actual keys of nodes in the open list; items with different key are outdated
+	unordered_map<int, Key> openKeys;
+	// tiles that have changed since the last calculation
+	vector<int> changedTiles;
+	// bounds of tiles reached by the search
+	int minX, minY, maxX, maxY;
+
+public:
+
+	/**
+	* Creates a new planner; use GameMap::GetPathPlanner so that the planner is shared and notified about map changes
+	* @param gameMap map to search in
+	* @param start start position
+	* @param goal final position
+	* @param crossForbiddenArea if true, forbidden area may be crossed
+	*/
+	IncrementalPathPlanner(GameMap* gameMap, Vec2i start, Vec2i goal, bool crossForbiddenArea);
+
+	~IncrementalPathPlanner();
+
+	/**
+	* Moves the start of the search (e.g. when the unit has already gone a part of the path)
+	*/
+	void SetStart(Vec2i start);
+
+	/**
+	* Calculates path from start to goal, repairing the previous search where the map has changed
+	* @param output output collection of steps, including the start and the goal
+	* @param maxIteration maximal number of expanded nodes (0 for infinite)
+	* @return true, if the path has been found
+	*/
+	bool CalcPath(vector<Vec2i>& output, int maxIteration = 0);
+
+	/**
+	* Gets index of the goal tile
+	*/
+	int GetGoal() const {
+		return goal;
+	}
+
+	/**
+	* Gets indicator whether forbidden area may be crossed
+	*/
+	bool CrossesForbiddenArea() const {
+		return crossForbiddenArea;
+	}
+
+	/**
+	* Notifies the planner that a tile has changed; called by the map
+	* Tiles outside the searched area are ignored, they can't affect the search
+	*/
+	void OnTileChanged(int index);
+
+private:
+
+	/**
+	* Gets cost-to-goal estimate of a tile
+	*/
+	int GetG(int index) const;
+
+	/**
+	* Gets one-step lookahead cost-to-goal value of a tile
+	*/
+	int GetRhs(int index) const;
+
+	/**
+	* Calculates priority of a tile in the open list
+	*/
+	Key CalcKey(int index) const;
+
+	/**
+	* Sets rhs value of a tile and extends the bounds of the searched area
+	*/
+	void SetRhs(int index, int value);
+
+	/**
+	* Recalculates rhs value of a tile and updates its position in the open list
+	*/
+	void UpdateVertex(int index);
+
+	/**
+	* Expands nodes until the start is consistent
+	*/
+	bool ComputeShortestPath(int maxIteration);
+
+	/**
+	* Gets key of the first valid item in the open list
+	*/
+	Key GetTopKey();
+};
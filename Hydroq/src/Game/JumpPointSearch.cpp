@@ -0,0 +1,20 @@
+#include "JumpPointSearch.h"
+#include <climits>
+
+JumpPointSearch& JumpPointSearch::GetThreadSearch() {
+	static thread_local JumpPointSearch search;
+	return search;
+}
+
+void JumpPointSearch::Prepare(int size) {
+	if (stamps.size() != size || searchStamp == INT_MAX) {
+		// the first search over this map
+		stamps.assign(size, 0);
+		costs.assign(size, 0);
+		parents.assign(size, -1);
+		closed.assign(size, false);
+		searchStamp = 0;
+	}
+
+	searchStamp++;
+}
@@ -0,0 +1,275 @@
+#pragma once
+
+#include "Vec2i.h"
+#include <queue>
+#include <algorithm>
+
+using namespace Cog;
+
+/**
+* Jump Point Search over the uniform-cost grid of the map
+* Diagonal steps can't cut corners, so that the paths are equal in cost to those
+* found by the A* search; straight lines of tiles are skipped by jumps, which leaves
+* only a few nodes in the open list
+* The jumps assume uniform costs, hence forbidden tiles can't carry the penalty the A* search
+* gives them; if there are any on the way, JPS may return a different route than A*
+* Each thread has its own search, see GetThreadSearch
+*
+* The grid must provide GetWidth(), GetHeight(), IsPassable(x, y, crossForbiddenArea)
+* and CalcHeuristic(from, to), just as for SearchArena
+*/
+class JumpPointSearch {
+private:
+	// if true, forbidden tiles are considered passable in the actual search
+	bool ignoreForbidden = false;
+	// goal of the actual search
+	int goal = 0;
+	// stamp of the actual search
+	int searchStamp = 0;
+	// stamp of the search that has reached each tile
+	vector<int> stamps;
+	// cost from the start, valid for tiles with actual stamp
+	vector<int> costs;
+	// previous jump point, valid for tiles with actual stamp
+	vector<int> parents;
+	// indicator whether the tile has already been expanded (valid for tiles with actual stamp)
+	vector<bool> closed;
+
+public:
+
+	/**
+	* Gets search of the calling thread
+	*/
+	static JumpPointSearch& GetThreadSearch();
+
+	/**
+	* Finds path from start to end
+	* @param crossForbiddenArea if true, forbidden tiles are passable with no penalty, i.e. they cost as much as any
+	* other tile; GameMap searches without them first, so that the area is crossed only if there is no other way
+	* @param output output collection of steps (every tile of the path, including the start and the end)
+	* @param maxIteration maximal number of expanded jump points (0 for infinite)
+	* @return true, if the path has been found
+	*/
+	template<class Grid>
+	bool Search(const Grid& grid, Vec2i start, Vec2i end, bool crossForbiddenArea, vector<Vec2i>& output, int maxIteration = 0) {
+		int width = grid.GetWidth();
+		int startIndex = start.y*width + start.x;
+		this->goal = end.y*width + end.x;
+		this->ignoreForbidden = crossForbiddenArea;
+
+		if (!IsPassable(grid, end.x, end.y)) return false;
+
+		Prepare(width*grid.GetHeight());
+		stamps[startIndex] = searchStamp;
+		costs[startIndex] = 0;
+		parents[startIndex] = -1;
+		closed[startIndex] = false;
+
+		priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> openList;
+		openList.push(make_pair(grid.CalcHeuristic(startIndex, goal), startIndex));
+
+		int iterations = 0;
+		int dirsX[8];
+		int dirsY[8];
+
+		while (!openList.empty()) {
+			int actual = openList.top().second;
+			openList.pop();
+
+			if (closed[actual]) continue;
+			closed[actual] = true;
+
+			if (actual == goal) {
+				// connect the jump points by straight and diagonal lines
+				int offset = output.size();
+				output.push_back(end);
+
+				for (int point = goal; parents[point] != -1; point = parents[point]) {
+					Vec2i from = Vec2i(parents[point] % width, parents[point] / width);
+					Vec2i to = Vec2i(point % width, point / width);
+					int dirX = (from.x < to.x) - (from.x > to.x);
+					int dirY = (from.y < to.y) - (from.y > to.y);
+
+					for (Vec2i pos = Vec2i(to.x - dirX, to.y - dirY); !(pos == from); pos = Vec2i(pos.x - dirX, pos.y - dirY)) {
+						output.push_back(pos);
+					}
+					output.push_back(from);
+				}
+
+				reverse(output.begin() + offset, output.end());
+				return true;
+			}
+
+			if (maxIteration != 0 && iterations++ >= maxIteration) {
+				return false;
+			}
+
+			int x = actual % width;
+			int y = actual / width;
+			int dirsNum = GetSuccessorDirections(grid, actual, dirsX, dirsY);
+
+			for (int i = 0; i < dirsNum; i++) {
+				int jumpPoint = Jump(grid, x, y, dirsX[i], dirsY[i]);
+				if (jumpPoint == -1) continue;
+
+				// jump points lie on a straight or diagonal line -> the octile distance is the exact cost
+				int cost = costs[actual] + grid.CalcHeuristic(actual, jumpPoint);
+
+				if (stamps[jumpPoint] != searchStamp) {
+					stamps[jumpPoint] = searchStamp;
+					closed[jumpPoint] = false;
+				}
+				else if (closed[jumpPoint] || costs[jumpPoint] <= cost) {
+					continue;
+				}
+
+				costs[jumpPoint] = cost;
+				parents[jumpPoint] = actual;
+				openList.push(make_pair(cost + grid.CalcHeuristic(jumpPoint, goal), jumpPoint));
+			}
+		}
+
+		return false;
+	}
+
+private:
+
+	/**
+	* Starts a new search over a map of selected size
+	*/
+	void Prepare(int size);
+
+	/**
+	* Returns true, if the tile at selected coordinates lies inside the map and can be entered
+	*/
+	template<class Grid>
+	bool IsPassable(const Grid& grid, int x, int y) const {
+		return grid.IsPassable(x, y, ignoreForbidden);
+	}
+
+	/**
+	* Jumps from a tile in selected direction
+	* @return index of the found jump point or -1
+	*/
+	template<class Grid>
+	int Jump(const Grid& grid, int x, int y, int dirX, int dirY) const {
+		if (dirX == 0 || dirY == 0) {
+			return JumpStraight(grid, x, y, dirX, dirY);
+		}
+
+		while (true) {
+			// diagonal steps can't cut corners
+			if (!IsPassable(grid, x + dirX, y + dirY) || !IsPassable(grid, x + dirX, y) || !IsPassable(grid, x, y + dirY)) {
+				return -1;
+			}
+
+			x += dirX;
+			y += dirY;
+			int index = y*grid.GetWidth() + x;
+
+			if (index == goal || JumpStraight(grid, x, y, dirX, 0) != -1 || JumpStraight(grid, x, y, 0, dirY) != -1) {
+				return index;
+			}
+		}
+	}
+
+	/**
+	* Jumps from a tile in selected straight direction
+	* @return index of the found jump point or -1
+	*/
+	template<class Grid>
+	int JumpStraight(const Grid& grid, int x, int y, int dirX, int dirY) const {
+		while (true) {
+			if (!IsPassable(grid, x + dirX, y + dirY)) {
+				return -1;
+			}
+
+			x += dirX;
+			y += dirY;
+			int index = y*grid.GetWidth() + x;
+
+			if (index == goal) {
+				return index;
+			}
+
+			// forced neighbors: tiles at the side that couldn't be reached diagonally from the previous tile
+			if (dirY == 0) {
+				if ((IsPassable(grid, x, y - 1) && !IsPassable(grid, x - dirX, y - 1)) || (IsPassable(grid, x, y + 1) && !IsPassable(grid, x - dirX, y + 1))) {
+					return index;
+				}
+			}
+			else {
+				if ((IsPassable(grid, x - 1, y) && !IsPassable(grid, x - 1, y - dirY)) || (IsPassable(grid, x + 1, y) && !IsPassable(grid, x + 1, y - dirY))) {
+					return index;
+				}
+			}
+		}
+	}
+
+	/**
+	* Collects directions in which the search continues from a jump point
+	* (pruned by the direction the jump point has been reached from)
+	* @param dirsX output horizontal offsets (up to 8)
+	* @param dirsY output vertical offsets (up to 8)
+	* @return number of directions
+	*/
+	template<class Grid>
+	int GetSuccessorDirections(const Grid& grid, int index, int* dirsX, int* dirsY) const {
+		// offsets of neighbors in 8 directions
+		static const int allDirX[] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+		static const int allDirY[] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+
+		int width = grid.GetWidth();
+		int parent = parents[index];
+		int count = 0;
+
+		if (parent == -1) {
+			// start -> all directions
+			for (int i = 0; i < 8; i++) {
+				dirsX[count] = allDirX[i];
+				dirsY[count++] = allDirY[i];
+			}
+			return count;
+		}
+
+		int x = index % width;
+		int y = index / width;
+		int dirX = (parent % width < x) - (parent % width > x);
+		int dirY = (parent / width < y) - (parent / width > y);
+
+		auto add = [&](int dx, int dy) {
+			dirsX[count] = dx;
+			dirsY[count++] = dy;
+		};
+
+		if (dirX != 0 && dirY != 0) {
+			bool horizontal = IsPassable(grid, x + dirX, y);
+			bool vertical = IsPassable(grid, x, y + dirY);
+			if (vertical) add(0, dirY);
+			if (horizontal) add(dirX, 0);
+			if (horizontal && vertical) add(dirX, dirY);
+		}
+		else if (dirX != 0) {
+			bool next = IsPassable(grid, x + dirX, y);
+			bool top = IsPassable(grid, x, y - 1);
+			bool bottom = IsPassable(grid, x, y + 1);
+			if (next) add(dirX, 0);
+			if (next && top) add(dirX, -1);
+			if (next && bottom) add(dirX, 1);
+			if (top) add(0, -1);
+			if (bottom) add(0, 1);
+		}
+		else {
+			bool next = IsPassable(grid, x, y + dirY);
+			bool left = IsPassable(grid, x - 1, y);
+			bool right = IsPassable(grid, x + 1, y);
+			if (next) add(0, dirY);
+			if (next && left) add(-1, dirY);
+			if (next && right) add(1, dirY);
+			if (left) add(-1, 0);
+			if (right) add(1, 0);
+		}
+
+		return count;
+	}
+};
@@ -0,0 +1,176 @@
+#include "MapBinary.h"
+#include "GameMap.h"
+#include <fstream>
+#include <cstring>
+#include <climits>
+
+// identifier of the format
+static const char mapBinaryMagic[] = { 'H', 'Q', 'M', 'P' };
+
+/**
+* Aligns offset to 8 bytes
+*/
+static uint32 AlignOffset(uint32 offset) {
+	return (offset + 7) & ~7u;
+}
+
+/**
+* Adds bytes to FNV-1a hash
+*/
+static uint64 HashBytes(uint64 hash, const unsigned char* data, size_t size) {
+	for (size_t i = 0; i < size; i++) {
+		hash = (hash ^ data[i]) * 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+/**
+* Adds string to FNV-1a hash, including its terminating zero
+*/
+static uint64 HashString(uint64 hash, const string& str) {
+	return HashBytes(hash, reinterpret_cast<const unsigned char*>(str.c_str()), str.size() + 1);
+}
+
+bool MapBinary::Open(string path, uint64 sourceHash) {
+	header = nullptr;
+
+	if (!file.Open(ofToDataPath(path))) {
+		return false;
+	}
+
+	auto mappedHeader = reinterpret_cast<const MapBinaryHeader*>(file.GetData());
+
+	if (file.GetSize() < sizeof(MapBinaryHeader) || memcmp(mappedHeader->magic, mapBinaryMagic, 4) != 0
+		|| mappedHeader->version != MAP_BINARY_VERSION || mappedHeader->fileSize != file.GetSize()
+		|| mappedHeader->sourceHash != sourceHash) {
+		// stale or damaged blob
+		file.Close();
+		return false;
+	}
+
+	header = mappedHeader;
+
+	if (!CheckPlanes()) {
+		// damaged blob
+		header = nullptr;
+		file.Close();
+		return false;
+	}
+
+	return true;
+}
+
+bool MapBinary::CheckPlanes() const {
+	uint64 size = (uint64)header->width*header->height;
+	uint64 rigsNum = header->rigsNum;
+
+	bool planesInFile = size > 0 && size <= INT_MAX
+		&& header->walkableRowWords == (header->width + 63) / 64
+		&& header->rigsOffset % sizeof(int) == 0 && header->rigPlatformsOffset % sizeof(int) == 0
+		&& header->walkableBitsOffset % sizeof(uint64) == 0
+		&& IsInFile(header->tileTypesOffset, size)
+		&& IsInFile(header->tileIndicesOffset, size)
+		&& IsInFile(header->rigsOffset, rigsNum * sizeof(int))
+		&& IsInFile(header->rigPlatformsOffset, rigsNum * MAP_RIG_PLATFORMS * sizeof(int))
+		&& IsInFile(header->walkableBitsOffset, (uint64)header->walkableRowWords*header->height * sizeof(uint64));
+
+	if (!planesInFile) {
+		return false;
+	}
+
+	auto tileTypes = GetTileTypes();
+	for (uint64 i = 0; i < size; i++) {
+		if (tileTypes[i] > (unsigned char)MapTileType::RIG_PLATFORM) return false;
+	}
+
+	// indices of the tables are used to access the tiles directly
+	auto rigs = GetRigs();
+	for (uint64 i = 0; i < rigsNum; i++) {
+		if (rigs[i] < 0 || (uint64)rigs[i] >= size) return false;
+	}
+
+	auto rigPlatforms = GetRigPlatforms();
+	for (uint64 i = 0; i < rigsNum * MAP_RIG_PLATFORMS; i++) {
+		if (rigPlatforms[i] < -1 || (rigPlatforms[i] != -1 && (uint64)rigPlatforms[i] >= size)) return false;
+	}
+
+	return true;
+}
+
+string MapBinary::GetBinaryPath(string mapPath) {
+	auto extension = mapPath.find_last_of('.');
+	return (extension == string::npos ? mapPath : mapPath.substr(0, extension)) + MAP_BINARY_EXTENSION;
+}
+
+uint64 MapBinary::CalcSourceHash(Settings& mapConfig, string mapPath) {
+	// FNV-1a offset basis
+	uint64 hash = 0xCBF29CE484222325ULL;
+
+	MappedFile image;
+	if (image.Open(ofToDataPath(mapPath))) {
+		hash = HashBytes(hash, image.GetData(), image.GetSize());
+	}
+
+	// colors of tiles in the image
+	auto names = mapConfig.GetSetting("names");
+	for (auto& item : names.items) {
+		hash = HashString(hash, item.second.key);
+		for (auto& value : item.second.GetValues()) {
+			hash = HashString(hash, value);
+		}
+	}
+
+	return hash;
+}
+
+bool MapBinary::Compile(GameMap& map, string path, uint64 sourceHash) {
+	uint32 size = map.width*map.height;
+
+	MapBinaryHeader header;
+	memcpy(header.magic, mapBinaryMagic, 4);
+	header.version = MAP_BINARY_VERSION;
+	header.width = map.width;
+	header.height = map.height;
+	header.rigsNum = map.rigs.size();
+	header.walkableRowWords = map.walkableRowWords;
+	header.tileTypesOffset = AlignOffset(sizeof(MapBinaryHeader));
+	header.tileIndicesOffset = AlignOffset(header.tileTypesOffset + size);
+	header.rigsOffset = AlignOffset(header.tileIndicesOffset + size);
+	header.rigPlatformsOffset = AlignOffset(header.rigsOffset + header.rigsNum * sizeof(int));
+	header.walkableBitsOffset = AlignOffset(header.rigPlatformsOffset + header.rigsNum * MAP_RIG_PLATFORMS * sizeof(int));
+	header.fileSize = header.walkableBitsOffset + map.walkableBits.size() * sizeof(uint64);
+	header.sourceHash = sourceHash;
+
+	vector<unsigned char> blob(header.fileSize, 0);
+	memcpy(&blob[0], &header, sizeof(MapBinaryHeader));
+	memcpy(&blob[header.tileTypesOffset], map.tileTypes.data(), size);
+	memcpy(&blob[header.tileIndicesOffset], map.tileIndices.data(), size);
+	if (!map.rigs.empty()) {
+		memcpy(&blob[header.rigsOffset], map.rigs.data(), map.rigs.size() * sizeof(int));
+		memcpy(&blob[header.rigPlatformsOffset], map.rigPlatforms.data(), map.rigPlatforms.size() * sizeof(int));
+	}
+	memcpy(&blob[header.walkableBitsOffset], map.walkableBits.data(), map.walkableBits.size() * sizeof(uint64));
+
+	ofstream output(ofToDataPath(path), ios::binary | ios::trunc);
+	output.write(reinterpret_cast<const char*>(blob.data()), blob.size());
+	return output.good();
+}
+
+void MapBinary::CompileAll(Settings& mapConfig) {
+	auto mapsFiles = mapConfig.GetSetting("maps_files");
+
+	for (auto& item : mapsFiles.items) {
+		string mapPath = mapConfig.GetSettingVal("maps_files", item.second.key);
+		string binaryPath = GetBinaryPath(mapPath);
+
+		GameMap map;
+		map.LoadMapImage(mapConfig, mapPath);
+
+		if (Compile(map, binaryPath, CalcSourceHash(mapConfig, mapPath))) {
+			CogLogInfo("Hydroq", "Map %s compiled into %s", item.second.key.c_str(), binaryPath.c_str());
+		}
+		else {
+			CogLogError("Hydroq", "Map %s couldn't be written into %s", item.second.key.c_str(), binaryPath.c_str());
+		}
+	}
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "Settings.h"
+#include "MappedFile.h"
+
+using namespace Cog;
+
+class GameMap;
+
+// version of the binary map format; blobs of other versions are ignored
+#define MAP_BINARY_VERSION 2
+// extension of compiled maps, stored next to the map images
+#define MAP_BINARY_EXTENSION ".hqmap"
+// number of platform tiles around each rig
+#define MAP_RIG_PLATFORMS 12
+
+/**
+* Header of the binary map; all planes are aligned to 8 bytes
+*/
+struct MapBinaryHeader {
+	// identifier of the format
+	char magic[4];
+	// version of the format
+	uint32 version;
+	// width of the map (in number of tiles)
+	uint32 width;
+	// height of the map (in number of tiles)
+	uint32 height;
+	// number of rigs
+	uint32 rigsNum;
+	// number of 64-bit words per row of the walkability plane
+	uint32 walkableRowWords;
+	// offset of the plane of tile types (one byte per tile)
+	uint32 tileTypesOffset;
+	// offset of the plane of sprite indices (one byte per tile)
+	uint32 tileIndicesOffset;
+	// offset of the table of rigs (index of the top-left tile of each rig)
+	uint32 rigsOffset;
+	// offset of the table of rig platforms (MAP_RIG_PLATFORMS indices per rig, -1 outside the map)
+	uint32 rigPlatformsOffset;
+	// offset of the walkability plane (one bit per tile)
+	uint32 walkableBitsOffset;
+	// size of the whole file
+	uint32 fileSize;
+	// hash of the map image and the tile names the map has been compiled from
+	uint64 sourceHash;
+};
+
+/**
+* Precompiled map, memory-mapped from a file; holds all tile planes and tables
+* the GameMap would otherwise build from the map image
+*/
+class MapBinary {
+private:
+	// mapped file
+	MappedFile file;
+	// header of the mapped file
+	const MapBinaryHeader* header = nullptr;
+
+public:
+
+	/**
+	* Maps compiled map into memory
+	* @param sourceHash hash of the sources the map should be compiled from, see CalcSourceHash
+	* @return true, if the file exists, has the actual version and has been compiled from the actual sources
+	*/
+	bool Open(string path, uint64 sourceHash);
+
+	int GetWidth() const {
+		return header->width;
+	}
+
+	int GetHeight() const {
+		return header->height;
+	}
+
+	int GetRigsNum() const {
+		return header->rigsNum;
+	}
+
+	int GetWalkableRowWords() const {
+		return header->walkableRowWords;
+	}
+
+	const unsigned char* GetTileTypes() const {
+		return file.GetData() + header->tileTypesOffset;
+	}
+
+	const unsigned char* GetTileIndices() const {
+		return file.GetData() + header->tileIndicesOffset;
+	}
+
+	const int* GetRigs() const {
+		return reinterpret_cast<const int*>(file.GetData() + header->rigsOffset);
+	}
+
+	const int* GetRigPlatforms() const {
+		return reinterpret_cast<const int*>(file.GetData() + header->rigPlatformsOffset);
+	}
+
+	const uint64* GetWalkableBits() const {
+		return reinterpret_cast<const uint64*>(file.GetData() + header->walkableBitsOffset);
+	}
+
+	/**
+	* Gets path of the compiled map that belongs to selected map image
+	*/
+	static string GetBinaryPath(string mapPath);
+
+	/**
+	* Calculates hash of the map image and the tile names of the map configuration;
+	* a compiled map is stale if any of them has changed
+	* @param mapConfig configuration of maps
+	* @param mapPath path to the map image
+	*/
+	static uint64 CalcSourceHash(Settings& mapConfig, string mapPath);
+
+	/**
+	* Writes loaded map into a file
+	* @param sourceHash hash of the sources the map has been loaded from
+	* @return true, if the file has been written
+	*/
+	static bool Compile(GameMap& map, string path, uint64 sourceHash);
+
+	/**
+	* Compiles all maps listed in the map configuration
+	* Enabled by map_compile setting in config.xml
+	*/
+	static void CompileAll(Settings& mapConfig);
+
+private:
+
+	/**
+	* Returns true, if a plane of selected length at selected offset lies inside the mapped file
+	*/
+	bool IsInFile(uint32 offset, uint64 length) const {
+		return offset + length <= file.GetSize();
+	}
+
+	/**
+	* Returns true, if all planes lie inside the mapped file, aligned to their types, tile types are valid
+	* and the rig tables point to tiles inside the map
+	*/
+	bool CheckPlanes() const;
+};
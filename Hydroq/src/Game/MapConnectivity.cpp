@@ -0,0 +1,184 @@
+#include "MapConnectivity.h"
+#include "GameMap.h"
+
+// offsets of neighbors in 4 directions (diagonal steps can't cut corners, so they don't connect anything else)
+static const int connDirX[] = { 0, 1, 0, -1 };
+static const int connDirY[] = { -1, 0, 1, 0 };
+
+void MapConnectivity::Init(GameMap* gameMap) {
+	this->gameMap = gameMap;
+	int size = gameMap->GetWidth()*gameMap->GetHeight();
+	labels.assign(size, -1);
+	componentSizes.clear();
+	freeLabels.clear();
+	visitStamps.assign(size, 0);
+	visitGroups.assign(size, 0);
+	searchStamp = 0;
+
+	for (int i = 0; i < size; i++) {
+		if (labels[i] == -1 && gameMap->IsWalkable(i)) {
+			int label = CreateLabel(0);
+			componentSizes[label] = FloodFill(i, label);
+		}
+	}
+}
+
+void MapConnectivity::OnTileChanged(int index) {
+	bool walkable = gameMap->IsWalkable(index);
+
+	if (walkable && labels[index] == -1) {
+		AddTile(index);
+	}
+	else if (!walkable && labels[index] != -1) {
+		RemoveTile(index);
+	}
+}
+
+int MapConnectivity::CreateLabel(int size) {
+	if (!freeLabels.empty()) {
+		int label = freeLabels.back();
+		freeLabels.pop_back();
+		componentSizes[label] = size;
+		return label;
+	}
+
+	componentSizes.push_back(size);
+	return componentSizes.size() - 1;
+}
+
+int MapConnectivity::FloodFill(int start, int label) {
+	vector<int> openList;
+	openList.push_back(start);
+	labels[start] = label;
+
+	for (int i = 0; i < openList.size(); i++) {
+		for (int j = 0; j < 4; j++) {
+			int neighbor = gameMap->GetNeighborIndex(openList[i], connDirX[j], connDirY[j]);
+			if (neighbor != -1 && labels[neighbor] != label && gameMap->IsWalkable(neighbor)) {
+				labels[neighbor] = label;
+				openList.push_back(neighbor);
+			}
+		}
+	}
+
+	return openList.size();
+}
+
+void MapConnectivity::AddTile(int index) {
+	int largest = -1;
+	int neighborLabels[4];
+
+	for (int i = 0; i < 4; i++) {
+		int neighbor = gameMap->GetNeighborIndex(index, connDirX[i], connDirY[i]);
+		neighborLabels[i] = neighbor == -1 ? -1 : labels[neighbor];
+		if (neighborLabels[i] != -1 && (largest == -1 || componentSizes[neighborLabels[i]] > componentSizes[largest])) {
+			largest = neighborLabels[i];
+		}
+	}
+
+	if (largest == -1) {
+		// isolated tile
+		labels[index] = CreateLabel(1);
+		return;
+	}
+
+	labels[index] = largest;
+	componentSizes[largest]++;
+
+	// the tile bridges other components -> relabel the smaller ones
+	for (int i = 0; i < 4; i++) {
+		int label = neighborLabels[i];
+		if (label != -1 && label != largest && componentSizes[label] != 0) {
+			int neighbor = gameMap->GetNeighborIndex(index, connDirX[i], connDirY[i]);
+			componentSizes[largest] += FloodFill(neighbor, largest);
+			componentSizes[label] = 0;
+			freeLabels.push_back(label);
+		}
+	}
+}
+
+void MapConnectivity::RemoveTile(int index) {
+	int label = labels[index];
+	labels[index] = -1;
+	componentSizes[label]--;
+
+	// groups of the search, one for each walkable neighbor
+	int groups = 0;
+	int groupParents[4];
+	bool groupFinished[4];
+	vector<int> visited[4];
+	vector<int> openLists[4];
+	int openHeads[4];
+
+	searchStamp++;
+	for (int i = 0; i < 4; i++) {
+		int neighbor = gameMap->GetNeighborIndex(index, connDirX[i], connDirY[i]);
+		if (neighbor != -1 && labels[neighbor] == label) {
+			visitStamps[neighbor] = searchStamp;
+			visitGroups[neighbor] = groups;
+			groupParents[groups] = groups;
+			groupFinished[groups] = false;
+			visited[groups].push_back(neighbor);
+			openLists[groups].push_back(neighbor);
+			openHeads[groups] = 0;
+			groups++;
+		}
+	}
+
+	if (groups == 0) {
+		// the component has disappeared
+		freeLabels.push_back(label);
+		return;
+	}
+
+	auto findGroup = [&](int group) {
+		while (groupParents[group] != group) group = groupParents[group];
+		return group;
+	};
+
+	// run the searches from all neighbors in turns; a search that meets another one is joined with it
+	// and a search that runs out of tiles before meeting the others has found a separated piece;
+	// the last search left keeps the original label, so only the smaller pieces are explored entirely
+	while (true) {
+		int running = 0;
+		for (int i = 0; i < groups; i++) {
+			if (groupParents[i] == i && !groupFinished[i]) running++;
+		}
+		if (running <= 1) break;
+
+		for (int i = 0; i < groups; i++) {
+			if (groupParents[i] != i || groupFinished[i]) continue;
+
+			if (openHeads[i] == openLists[i].size()) {
+				// separated piece
+				int newLabel = CreateLabel(visited[i].size());
+				for (int tile : visited[i]) labels[tile] = newLabel;
+				componentSizes[label] -= visited[i].size();
+				groupFinished[i] = true;
+				break;
+			}
+
+			int actual = openLists[i][openHeads[i]++];
+			for (int j = 0; j < 4; j++) {
+				int neighbor = gameMap->GetNeighborIndex(actual, connDirX[j], connDirY[j]);
+				if (neighbor == -1 || labels[neighbor] != label) continue;
+
+				if (visitStamps[neighbor] != searchStamp) {
+					visitStamps[neighbor] = searchStamp;
+					visitGroups[neighbor] = i;
+					visited[i].push_back(neighbor);
+					openLists[i].push_back(neighbor);
+				}
+				else {
+					int other = findGroup(visitGroups[neighbor]);
+					if (other != i) {
+						// both searches belong to the same piece
+						groupParents[other] = i;
+						visited[i].insert(visited[i].end(), visited[other].begin(), visited[other].end());
+						openLists[i].insert(openLists[i].end(), openLists[other].begin() + openHeads[other], openLists[other].end());
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Vec2i.h"
+
+using namespace Cog;
+
+class GameMap;
+
+/**
+* Labels of connected components of walkable tiles (forbidden tiles included),
+* kept up to date as tiles are built or destroyed; two tiles with different labels
+* can't be connected by any path
+*/
+class MapConnectivity {
+private:
+	// link to the map
+	GameMap* gameMap = nullptr;
+	// label of each tile, -1 for tiles that aren't walkable
+	vector<int> labels;
+	// number of tiles of each component, by label
+	vector<int> componentSizes;
+	// labels that aren't used anymore
+	vector<int> freeLabels;
+	// stamp of the actual search
+	int searchStamp = 0;
+	// stamp of the search that visited each tile
+	vector<int> visitStamps;
+	// id of the search group that visited each tile
+	vector<int> visitGroups;
+
+public:
+
+	/**
+	* Labels the whole map
+	*/
+	void Init(GameMap* gameMap);
+
+	/**
+	* Updates labels around a tile that may have been built or destroyed
+	*/
+	void OnTileChanged(int index);
+
+	/**
+	* Gets label of the component selected tile belongs to or -1 if the tile isn't walkable
+	*/
+	int GetLabel(int index) const {
+		return labels[index];
+	}
+
+	/**
+	* Gets number of tiles of a component
+	*/
+	int GetComponentSize(int label) const {
+		return componentSizes[label];
+	}
+
+	/**
+	* Returns false, if there is surely no path between both tiles;
+	* tiles that aren't walkable (e.g. a unit standing at a destroyed bridge) are always considered connected
+	*/
+	bool MayBeConnected(int first, int second) const {
+		return labels[first] == -1 || labels[second] == -1 || labels[first] == labels[second];
+	}
+
+private:
+
+	/**
+	* Creates a new label for a component of given size
+	*/
+	int CreateLabel(int size);
+
+	/**
+	* Assigns a label to all tiles reachable from selected tile that have a different label
+	* @return number of relabeled tiles
+	*/
+	int FloodFill(int start, int label);
+
+	/**
+	* Joins a new walkable tile with its neighbors
+	*/
+	void AddTile(int index);
+
+	/**
+	* Splits the component of a tile that isn't walkable anymore, if necessary
+	*/
+	void RemoveTile(int index);
+};
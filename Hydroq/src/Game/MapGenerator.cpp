@@ -0,0 +1,94 @@
+#include "MapGenerator.h"
+#include <algorithm>
+
+// size of the rig including its ring of platforms
+#define RIG_FOOTPRINT 4
+
+void MapGenerator::Generate(int width, int height, int seed, float rigDensity, TileMap& output) {
+	width = max(RIG_FOOTPRINT, min(width, MAP_GENERATOR_MAX_SIZE));
+	height = max(RIG_FOOTPRINT, min(height, MAP_GENERATOR_MAX_SIZE));
+
+	std::mt19937 random(seed);
+
+	vector<unsigned char> ground;
+	GenerateLand(width, height, random, ground);
+
+	output.width = width;
+	output.height = height;
+	output.tiles.clear();
+	output.tiles.resize(width*height);
+
+	for (int i = 0; i < width*height; i++) {
+		output.tiles[i].name = ground[i] ? "ground" : "water";
+		output.tiles[i].index = 0;
+	}
+
+	int rigsNum = max(2, (int)(rigDensity * width * height / 10000));
+	PlaceRigs(width, height, rigsNum, random, output);
+}
+
+void MapGenerator::GenerateLand(int width, int height, std::mt19937& random, vector<unsigned char>& ground) {
+	std::uniform_real_distribution<float> noise(0, 1);
+	ground.resize(width*height);
+
+	for (auto& tile : ground) {
+		tile = noise(random) < MAP_GENERATOR_GROUND_RATIO ? 1 : 0;
+	}
+
+	// cellular automaton: each tile takes the majority of its 3x3 neighborhood
+	vector<unsigned char> next(width*height);
+
+	for (int pass = 0; pass < MAP_GENERATOR_SMOOTHING; pass++) {
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				int groundNum = 0;
+				for (int j = max(0, y - 1); j <= min(height - 1, y + 1); j++) {
+					for (int i = max(0, x - 1); i <= min(width - 1, x + 1); i++) {
+						groundNum += ground[j*width + i];
+					}
+				}
+				// tiles outside the map count as water
+				next[y*width + x] = groundNum >= 5 ? 1 : 0;
+			}
+		}
+		ground.swap(next);
+	}
+}
+
+void MapGenerator::PlaceRigs(int width, int height, int rigsNum, std::mt19937& random, TileMap& output) {
+	// offsets of platforms from the top-left tile of a rig
+	static const int platformX[] = { -1, 0, 1, 2, 2, 2, 2, 1, 0, -1, -1, -1 };
+	static const int platformY[] = { -1, -1, -1, -1, 0, 1, 2, 2, 2, 2, 1, 0 };
+
+	// the map is divided into cells, each holding at most one rig
+	int cellSize = max(RIG_FOOTPRINT + 1, (int)sqrt((float)width*height / rigsNum));
+	int cellsX = width / cellSize;
+	int cellsY = height / cellSize;
+
+	vector<int> cells;
+	for (int i = 0; i < cellsX*cellsY; i++) {
+		cells.push_back(i);
+	}
+	shuffle(cells.begin(), cells.end(), random);
+
+	int placed = min(rigsNum, (int)cells.size());
+
+	for (int i = 0; i < placed; i++) {
+		// random position of the footprint inside the cell, with one free tile to the next cell
+		std::uniform_int_distribution<int> offset(0, cellSize - RIG_FOOTPRINT - 1);
+		int x = (cells[i] % cellsX)*cellSize + offset(random) + 1;
+		int y = (cells[i] / cellsX)*cellSize + offset(random) + 1;
+
+		for (int part = 0; part < 4; part++) {
+			auto& tile = output.tiles[(y + part / 2)*width + x + part % 2];
+			tile.name = "rig";
+			tile.index = part;
+		}
+
+		for (int k = 0; k < 12; k++) {
+			auto& tile = output.tiles[(y + platformY[k])*width + x + platformX[k]];
+			tile.name = "rig_platform";
+			tile.index = 0;
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Tile.h"
+#include <random>
+
+using namespace Cog;
+
+// maximal width and height of generated maps
+#define MAP_GENERATOR_MAX_SIZE 2000
+// default number of rigs per 10 000 tiles
+#define MAP_GENERATOR_RIG_DENSITY 4.0f
+// ratio of ground tiles before smoothing
+#define MAP_GENERATOR_GROUND_RATIO 0.47f
+// number of smoothing passes that turn the noise into islands
+#define MAP_GENERATOR_SMOOTHING 4
+
+/**
+* Seeded generator of random maps of any size; generated maps consist of the same tiles
+* the map loader creates from map images (water, ground and 2x2 rigs surrounded by a ring
+* of rig platforms), so they can be loaded by GameMap::LoadMap(TileMap&) or compiled by MapBinary
+*/
+class MapGenerator {
+public:
+
+	/**
+	* Generates a new map
+	* @param width width of the map, at most MAP_GENERATOR_MAX_SIZE
+	* @param height height of the map, at most MAP_GENERATOR_MAX_SIZE
+	* @param seed seed of the random generator; the same seed gives the same map
+	* @param rigDensity number of rigs per 10 000 tiles (at least 2 rigs are placed, if they fit)
+	* @param output output tile map
+	*/
+	static void Generate(int width, int height, int seed, float rigDensity, TileMap& output);
+
+private:
+
+	/**
+	* Generates islands of ground in the water
+	* @param ground output plane, 1 for ground tiles
+	*/
+	static void GenerateLand(int width, int height, std::mt19937& random, vector<unsigned char>& ground);
+
+	/**
+	* Places rigs in cells of a regular grid so that they never overlap
+	*/
+	static void PlaceRigs(int width, int height, int rigsNum, std::mt19937& random, TileMap& output);
+};
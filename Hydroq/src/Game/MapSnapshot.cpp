@@ -0,0 +1,39 @@
+#include "MapSnapshot.h"
+#include "GameMap.h"
+
+MapSnapshot::MapSnapshot(GameMap* gameMap) : width(gameMap->GetWidth()), height(gameMap->GetHeight()) {
+	rows.resize(height);
+	rowTiles.resize(height);
+
+	for (int y = 0; y < height; y++) {
+		CopyRow(gameMap, y);
+	}
+}
+
+MapSnapshot::MapSnapshot(GameMap* gameMap, const MapSnapshot& previous, const vector<int>& changedRows)
+	: width(previous.width), height(previous.height), rows(previous.rows), rowTiles(previous.rowTiles) {
+
+	// the rows of the previous snapshot are still in use, the changed ones are replaced
+	for (int row : changedRows) {
+		CopyRow(gameMap, row);
+	}
+}
+
+int MapSnapshot::CalcHeuristic(int from, int to) const {
+	int dx = abs(from % width - to % width);
+	int dy = abs(from / width - to / width);
+	return dx > dy ? (MAP_STEP_COST*dx + (MAP_DIAGONAL_COST - MAP_STEP_COST)*dy)
+		: (MAP_STEP_COST*dy + (MAP_DIAGONAL_COST - MAP_STEP_COST)*dx);
+}
+
+void MapSnapshot::CopyRow(GameMap* gameMap, int row) {
+	auto tiles = spt<vector<unsigned char>>(new vector<unsigned char>(width));
+
+	for (int x = 0; x < width; x++) {
+		int index = row*width + x;
+		(*tiles)[x] = (gameMap->IsWalkable(index) ? SNAPSHOT_WALKABLE : 0) | (gameMap->IsForbidden(index) ? SNAPSHOT_FORBIDDEN : 0);
+	}
+
+	rows[row] = tiles;
+	rowTiles[row] = tiles->data();
+}
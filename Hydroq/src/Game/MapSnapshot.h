@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Vec2i.h"
+#include "GameMap.h"
+
+using namespace Cog;
+
+// flag of walkable tiles in the snapshot
+#define SNAPSHOT_WALKABLE 1
+// flag of forbidden tiles in the snapshot
+#define SNAPSHOT_FORBIDDEN 2
+
+/**
+* Immutable copy of the passability of the map; path queries running
+* on other threads search in the snapshot so that the map itself may change meanwhile
+* The tiles are stored by rows; a new snapshot shares unchanged rows with the previous one
+* and copies only the rows refreshed since then
+*/
+class MapSnapshot {
+private:
+	// width of the map
+	int width;
+	// height of the map
+	int height;
+	// rows of tile flags (SNAPSHOT_WALKABLE and SNAPSHOT_FORBIDDEN), shared among snapshots
+	vector<spt<vector<unsigned char>>> rows;
+	// data of the rows, for fast access
+	vector<const unsigned char*> rowTiles;
+
+public:
+
+	/**
+	* Creates a snapshot of the actual state of the map
+	*/
+	MapSnapshot(GameMap* gameMap);
+
+	/**
+	* Creates a snapshot of the actual state of the map from the previous snapshot
+	* @param previous previous snapshot of the same map
+	* @param changedRows rows that have changed since the previous snapshot has been created
+	*/
+	MapSnapshot(GameMap* gameMap, const MapSnapshot& previous, const vector<int>& changedRows);
+
+	/**
+	* Gets width of the map
+	*/
+	int GetWidth() const {
+		return width;
+	}
+
+	/**
+	* Gets height of the map
+	*/
+	int GetHeight() const {
+		return height;
+	}
+
+	/**
+	* Gets index of the tile at selected position
+	*/
+	int GetTileIndex(Vec2i pos) const {
+		return pos.y*width + pos.x;
+	}
+
+	/**
+	* Gets position of the tile at selected index
+	*/
+	Vec2i GetTilePosition(int index) const {
+		return Vec2i(index % width, index / width);
+	}
+
+	/**
+	* Gets indicator whether the tile at selected coordinates lies inside the map and can be entered
+	* @param crossForbiddenArea if true, forbidden tiles can be entered as well
+	*/
+	bool IsPassable(int x, int y, bool crossForbiddenArea) const {
+		if (x < 0 || y < 0 || x >= width || y >= height) return false;
+		unsigned char tile = rowTiles[y][x];
+		return (tile & SNAPSHOT_WALKABLE) != 0 && (crossForbiddenArea || (tile & SNAPSHOT_FORBIDDEN) == 0);
+	}
+
+	/**
+	* Gets cost of a step from the tile at selected index to its neighbor in given direction,
+	* or -1 if the step isn't possible (the same costs as GameMap::GetStepCost)
+	*/
+	int GetStepCost(int index, int dirX, int dirY, bool crossForbiddenArea) const {
+		int x = index % width;
+		int y = index / width;
+		if (!IsPassable(x + dirX, y + dirY, crossForbiddenArea)) return -1;
+
+		int cost = MAP_STEP_COST;
+		if (dirX != 0 && dirY != 0) {
+			// diagonal steps can't cut corners
+			if (!IsPassable(x + dirX, y, crossForbiddenArea) || !IsPassable(x, y + dirY, crossForbiddenArea)) return -1;
+			cost = MAP_DIAGONAL_COST;
+		}
+		return (rowTiles[y + dirY][x + dirX] & SNAPSHOT_FORBIDDEN) != 0 ? cost + MAP_FORBIDDEN_PENALTY : cost;
+	}
+
+	/**
+	* Calculates lower bound of the cost between two tiles (octile distance)
+	*/
+	int CalcHeuristic(int from, int to) const;
+
+private:
+
+	/**
+	* Copies selected row of the map
+	*/
+	void CopyRow(GameMap* gameMap, int row);
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+
+using namespace std;
+
+/**
+* Read-only file mapped into memory
+*/
+class MappedFile {
+private:
+	// beginning of the mapped data
+	const unsigned char* data = nullptr;
+	// size of the file in bytes
+	size_t size = 0;
+#ifdef _WIN32
+	// handle of the file
+	void* fileHandle = nullptr;
+	// handle of the mapping
+	void* mappingHandle = nullptr;
+#else
+	// file descriptor
+	int fileDescriptor = -1;
+#endif
+
+public:
+
+	MappedFile() {
+
+	}
+
+	~MappedFile() {
+		Close();
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/**
+	* Maps file at selected path into memory
+	* @return true, if the file has been mapped
+	*/
+	bool Open(string path);
+
+	/**
+	* Unmaps the file
+	*/
+	void Close();
+
+	/**
+	* Gets beginning of the mapped data or nullptr if no file is mapped
+	*/
+	const unsigned char* GetData() const {
+		return data;
+	}
+
+	/**
+	* Gets size of the mapped data in bytes
+	*/
+	size_t GetSize() const {
+		return size;
+	}
+};
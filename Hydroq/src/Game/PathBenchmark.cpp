@@ -0,0 +1,106 @@
+#include "PathBenchmark.h"
+#include "GameMap.h"
+#include "MapGenerator.h"
+#include <random>
+
+void PathBenchmark::Run(Settings& mapConfig, int queries, int seed) {
+	auto maps = mapConfig.GetSetting("maps_files");
+
+	for (auto& item : maps.items) {
+		string mapName = item.second.key;
+		GameMap map;
+		map.LoadMap(mapConfig, mapName);
+		RunOnMap(map, mapName, queries, seed);
+	}
+
+	// shipped maps are too small to show how the backends scale
+	TileMap generatedMap;
+	MapGenerator::Generate(PATH_BENCHMARK_GENERATED_SIZE, PATH_BENCHMARK_GENERATED_SIZE, seed, MAP_GENERATOR_RIG_DENSITY, generatedMap);
+	GameMap map;
+	map.LoadMap(generatedMap);
+	RunOnMap(map, "generated", queries, seed);
+}
+
+void PathBenchmark::RunOnMap(GameMap& map, string mapName, int queries, int seed) {
+	// collect walkable tiles
+	vector<Vec2i> walkable;
+	for (int i = 0; i < map.GetWidth()*map.GetHeight(); i++) {
+		if (map.IsWalkable(i)) walkable.push_back(map.GetTilePosition(i));
+	}
+
+	if (walkable.empty()) return;
+
+	// the same queries for all backends
+	std::mt19937 random(seed);
+	vector<pair<Vec2i, Vec2i>> pairs;
+	for (int i = 0; i < queries; i++) {
+		pairs.push_back(make_pair(walkable[random() % walkable.size()], walkable[random() % walkable.size()]));
+	}
+
+	// each query must be searched, as the callers would search it
+	map.GetPathCache().SetCapacity(0);
+
+	RunQueries(map, mapName, pairs);
+	ForbidAreas(map, seed);
+	RunQueries(map, mapName + " (forbidden areas)", pairs);
+}
+
+void PathBenchmark::RunQueries(GameMap& map, string mapName, vector<pair<Vec2i, Vec2i>>& queries) {
+	// A* goes first, the others are compared with it
+	PathSearchBackend backends[] = { PathSearchBackend::ASTAR, PathSearchBackend::JPS, PathSearchBackend::DEFAULT };
+	uint64 times[3];
+	vector<int> costs[3];
+
+	for (int i = 0; i < 3; i++) {
+		uint64 startTime = ofGetElapsedTimeMicros();
+		for (auto& query : queries) {
+			vector<Vec2i> path;
+			map.FindPath(query.first, query.second, true, path, 0, backends[i]);
+			costs[i].push_back(CalcPathCost(map, path));
+		}
+		times[i] = ofGetElapsedTimeMicros() - startTime;
+	}
+
+	int found = 0;
+	int mismatches[3] = { 0, 0, 0 };
+	for (int i = 0; i < queries.size(); i++) {
+		if (costs[0][i] != -1) found++;
+		for (int j = 1; j < 3; j++) {
+			if (costs[0][i] != costs[j][i]) mismatches[j]++;
+		}
+	}
+
+	CogLogInfo("Hydroq", "Path benchmark on map %s (%d queries, %d paths found): A* %d us, JPS %d us (%d paths differ in cost), "
+		"without backend (hierarchical for long paths) %d us (%d paths differ in cost)", mapName.c_str(), (int)queries.size(), found, (int)times[0], (int)times[1],
+		mismatches[1], (int)times[2], mismatches[2]);
+}
+
+void PathBenchmark::ForbidAreas(GameMap& map, int seed) {
+	std::mt19937 random(seed);
+	int areas = PATH_BENCHMARK_FORBIDDEN_RATIO * map.GetWidth() * map.GetHeight() / (PATH_BENCHMARK_FORBIDDEN_SIZE * PATH_BENCHMARK_FORBIDDEN_SIZE);
+
+	for (int i = 0; i < areas; i++) {
+		int left = random() % map.GetWidth();
+		int top = random() % map.GetHeight();
+
+		for (int y = top; y < min(top + PATH_BENCHMARK_FORBIDDEN_SIZE, map.GetHeight()); y++) {
+			for (int x = left; x < min(left + PATH_BENCHMARK_FORBIDDEN_SIZE, map.GetWidth()); x++) {
+				auto tile = map.GetTile(x, y);
+				tile->SetIsForbidden(true);
+				map.RefreshTile(tile);
+			}
+		}
+	}
+}
+
+int PathBenchmark::CalcPathCost(GameMap& map, vector<Vec2i>& path) {
+	if (path.empty()) return -1;
+
+	int cost = 0;
+	for (int i = 1; i < path.size(); i++) {
+		int stepCost = map.GetStepCost(map.GetTileIndex(path[i - 1]), path[i].x - path[i - 1].x, path[i].y - path[i - 1].y, true);
+		if (stepCost == -1) return -1;
+		cost += stepCost;
+	}
+	return cost;
+}
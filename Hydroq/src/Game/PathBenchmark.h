@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Settings.h"
+#include "Vec2i.h"
+
+using namespace Cog;
+
+class GameMap;
+
+// default number of path queries per map
+#define PATH_BENCHMARK_QUERIES 500
+// size of the generated map the benchmark runs on besides the shipped maps
+#define PATH_BENCHMARK_GENERATED_SIZE 512
+// size of the square forbidden areas placed on the maps in the second run [tiles]
+#define PATH_BENCHMARK_FORBIDDEN_SIZE 8
+// ratio of tiles covered by the forbidden areas in the second run
+#define PATH_BENCHMARK_FORBIDDEN_RATIO 0.1f
+
+/**
+* Benchmark of path search backends; runs the same random queries through GameMap::FindPath
+* (with the path cache disabled) on all maps with each backend, and with no backend selected,
+* which searches long paths over the hierarchical map
+* Logs the times and the number of paths that differ in cost from the A* search; each map is
+* searched once as it is and once with forbidden areas
+* Enabled by path_benchmark setting in config.xml
+*/
+class PathBenchmark {
+public:
+
+	/**
+	* Runs the benchmark on all maps listed in the map configuration and on a generated map
+	* @param mapConfig configuration of maps
+	* @param queries number of queries per map
+	* @param seed seed of the random generator of queries
+	*/
+	static void Run(Settings& mapConfig, int queries = PATH_BENCHMARK_QUERIES, int seed = 0);
+
+private:
+
+	/**
+	* Runs the benchmark on one map, both without and with forbidden areas
+	*/
+	static void RunOnMap(GameMap& map, string mapName, int queries, int seed);
+
+	/**
+	* Runs the queries with all backends and logs the results
+	*/
+	static void RunQueries(GameMap& map, string mapName, vector<pair<Vec2i, Vec2i>>& queries);
+
+	/**
+	* Forbids random square areas of the map
+	*/
+	static void ForbidAreas(GameMap& map, int seed);
+
+	/**
+	* Calculates cost of a path
+	*/
+	static int CalcPathCost(GameMap& map, vector<Vec2i>& path);
+};
@@ -0,0 +1,104 @@
+#include "PathCache.h"
+#include "GameMap.h"
+
+void PathCache::Init(GameMap* gameMap) {
+	this->gameMap = gameMap;
+	paths.clear();
+	pathsByKey.clear();
+	pathsByTile.clear();
+	hits = misses = 0;
+}
+
+void PathCache::SetCapacity(int capacity) {
+	this->capacity = capacity;
+
+	while ((int)pathsByKey.size() > max(capacity, 0)) {
+		RemovePath(prev(paths.end()));
+	}
+}
+
+bool PathCache::GetPath(Vec2i start, Vec2i end, bool crossForbiddenArea, PathSearchBackend backend, int maxIteration,
+	vector<Vec2i>& output) {
+	auto found = pathsByKey.find(CalcKey(start, end, crossForbiddenArea, backend));
+
+	// each step takes at least one iteration; the limited search couldn't find longer paths
+	if (found == pathsByKey.end() || (maxIteration != 0 && (int)found->second->steps.size() - 1 > maxIteration)) {
+		// the number of calls of each measure is the counter
+		COGMEASURE_BEGIN("HYDROQ_PATHCACHE_MISS");
+		misses++;
+		COGMEASURE_END("HYDROQ_PATHCACHE_MISS");
+		return false;
+	}
+
+	COGMEASURE_BEGIN("HYDROQ_PATHCACHE_HIT");
+	hits++;
+	// move to the front
+	paths.splice(paths.begin(), paths, found->second);
+	auto& steps = found->second->steps;
+	output.insert(output.end(), steps.begin(), steps.end());
+	COGMEASURE_END("HYDROQ_PATHCACHE_HIT");
+	return true;
+}
+
+void PathCache::InsertPath(Vec2i start, Vec2i end, bool crossForbiddenArea, PathSearchBackend backend, const vector<Vec2i>& steps) {
+	if (capacity <= 0) return;
+
+	uint64 key = CalcKey(start, end, crossForbiddenArea, backend);
+	auto found = pathsByKey.find(key);
+	if (found != pathsByKey.end()) {
+		RemovePath(found->second);
+	}
+	else if (pathsByKey.size() >= capacity) {
+		RemovePath(prev(paths.end()));
+	}
+
+	CachedPath path;
+	path.key = key;
+	path.steps = steps;
+
+	// a diagonal step depends also on both tiles around the corner
+	for (int i = 0; i < steps.size(); i++) {
+		path.tiles.push_back(gameMap->GetTileIndex(steps[i]));
+		if (i > 0 && steps[i].x != steps[i - 1].x && steps[i].y != steps[i - 1].y) {
+			path.tiles.push_back(gameMap->GetTileIndex(Vec2i(steps[i].x, steps[i - 1].y)));
+			path.tiles.push_back(gameMap->GetTileIndex(Vec2i(steps[i - 1].x, steps[i].y)));
+		}
+	}
+
+	for (int tile : path.tiles) {
+		pathsByTile[tile].insert(key);
+	}
+
+	paths.push_front(path);
+	pathsByKey[key] = paths.begin();
+}
+
+void PathCache::OnTileChanged(int index) {
+	auto found = pathsByTile.find(index);
+	if (found == pathsByTile.end()) return;
+
+	// copy the keys, the collection is modified during removal
+	vector<uint64> keys(found->second.begin(), found->second.end());
+	for (uint64 key : keys) {
+		RemovePath(pathsByKey[key]);
+	}
+}
+
+uint64 PathCache::CalcKey(Vec2i start, Vec2i end, bool crossForbiddenArea, PathSearchBackend backend) const {
+	uint64 startIndex = gameMap->GetTileIndex(start);
+	uint64 endIndex = gameMap->GetTileIndex(end);
+	return (startIndex << 34) | (endIndex << 3) | ((uint64)backend << 1) | (crossForbiddenArea ? 1 : 0);
+}
+
+void PathCache::RemovePath(list<CachedPath>::iterator path) {
+	for (int tile : path->tiles) {
+		auto found = pathsByTile.find(tile);
+		if (found != pathsByTile.end()) {
+			found->second.erase(path->key);
+			if (found->second.empty()) pathsByTile.erase(found);
+		}
+	}
+
+	pathsByKey.erase(path->key);
+	paths.erase(path);
+}
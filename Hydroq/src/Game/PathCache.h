@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Vec2i.h"
+#include "PathQueryPool.h"
+#include <list>
+
+using namespace Cog;
+
+class GameMap;
+
+// default number of paths the cache can hold
+#define PATH_CACHE_CAPACITY 256
+
+/**
+* Cached path between two tiles
+*/
+struct CachedPath {
+	// key of the path (endpoints, backend and forbidden-area flag)
+	uint64 key;
+	// steps of the path
+	vector<Vec2i> steps;
+	// indices of tiles the path depends on (steps and corners of diagonal steps)
+	vector<int> tiles;
+};
+
+/**
+* LRU cache of paths found by GameMap::FindPath; a path is removed as soon as
+* any tile it depends on is refreshed
+* Paths found by different backends are cached separately; a path is served to a query
+* with limited number of iterations only if the limit would suffice to find it
+*/
+class PathCache {
+private:
+	// link to the map
+	GameMap* gameMap = nullptr;
+	// maximal number of cached paths
+	int capacity;
+	// cached paths, the most recently used at the front
+	list<CachedPath> paths;
+	// paths by their keys
+	unordered_map<uint64, list<CachedPath>::iterator> pathsByKey;
+	// keys of paths that go through a tile, by tile index
+	unordered_map<int, unordered_set<uint64>> pathsByTile;
+	// number of successful lookups
+	int hits = 0;
+	// number of unsuccessful lookups
+	int misses = 0;
+
+public:
+
+	PathCache(int capacity = PATH_CACHE_CAPACITY) : capacity(capacity) {
+
+	}
+
+	/**
+	* Clears the cache and binds it to a map
+	*/
+	void Init(GameMap* gameMap);
+
+	/**
+	* Finds cached path
+	* @param backend backend of the query (the default one already resolved)
+	* @param maxIteration maximal number of iterations of the query (0 for infinite)
+	* @param output output collection the steps will be appended to
+	* @return true, if the path has been found
+	*/
+	bool GetPath(Vec2i start, Vec2i end, bool crossForbiddenArea, PathSearchBackend backend, int maxIteration, vector<Vec2i>& output);
+
+	/**
+	* Inserts a new path, the least recently used path is removed if the cache is full
+	* @param backend backend that has found the path
+	*/
+	void InsertPath(Vec2i start, Vec2i end, bool crossForbiddenArea, PathSearchBackend backend, const vector<Vec2i>& steps);
+
+	/**
+	* Removes all paths that depend on selected tile
+	*/
+	void OnTileChanged(int index);
+
+	/**
+	* Sets maximal number of cached paths; if 0, the cache is disabled
+	*/
+	void SetCapacity(int capacity);
+
+	/**
+	* Gets number of successful lookups
+	*/
+	int GetHits() const {
+		return hits;
+	}
+
+	/**
+	* Gets number of unsuccessful lookups
+	*/
+	int GetMisses() const {
+		return misses;
+	}
+
+	/**
+	* Gets number of cached paths
+	*/
+	int GetSize() const {
+		return pathsByKey.size();
+	}
+
+private:
+
+	/**
+	* Calculates key of a path
+	*/
+	uint64 CalcKey(Vec2i start, Vec2i end, bool crossForbiddenArea, PathSearchBackend backend) const;
+
+	/**
+	* Removes path from the cache
+	*/
+	void RemovePath(list<CachedPath>::iterator path);
+};
@@ -0,0 +1,129 @@
+#include "PathQueryPool.h"
+#include "MapSnapshot.h"
+#include "SearchArena.h"
+#include "JumpPointSearch.h"
+
+PathQueryPool::PathQueryPool(int threadsNum) {
+	if (threadsNum == 0) {
+		// the calling thread takes one core
+		threadsNum = min((int)std::thread::hardware_concurrency() - 1, PATH_QUERY_MAX_THREADS);
+	}
+
+	for (int i = 0; i < threadsNum; i++) {
+		threads.push_back(std::thread(&PathQueryPool::RunThread, this));
+	}
+}
+
+PathQueryPool::~PathQueryPool() {
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		terminating = true;
+	}
+	batchStarted.notify_all();
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+}
+
+void PathQueryPool::Process(spt<MapSnapshot> snapshot, vector<PathQuery>& queries) {
+	if (queries.empty()) return;
+
+	auto batch = spt<Batch>(new Batch());
+	batch->snapshot = snapshot;
+	batch->queries = &queries;
+	batch->size = queries.size();
+	batch->nextQuery = 0;
+	batch->processed = 0;
+
+	if (!threads.empty() && queries.size() > 1) {
+		std::unique_lock<std::mutex> lock(mutex);
+		actualBatch = batch;
+		batchCounter++;
+		lock.unlock();
+		batchStarted.notify_all();
+	}
+
+	ProcessBatch(*batch);
+
+	// wait for queries being processed by other threads
+	std::unique_lock<std::mutex> lock(mutex);
+	batchFinished.wait(lock, [&batch] { return batch->processed == batch->size; });
+	actualBatch = spt<Batch>();
+}
+
+void PathQueryPool::RunThread() {
+	int lastBatch = 0;
+
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while (true) {
+		batchStarted.wait(lock, [this, &lastBatch] { return terminating || batchCounter != lastBatch; });
+
+		if (terminating) {
+			return;
+		}
+
+		lastBatch = batchCounter;
+		// keep the batch alive even if the calling thread has already finished it
+		auto batch = actualBatch;
+		lock.unlock();
+
+		if (batch) {
+			ProcessBatch(*batch);
+		}
+
+		lock.lock();
+	}
+}
+
+void PathQueryPool::ProcessBatch(Batch& batch) {
+	while (true) {
+		int index = batch.nextQuery++;
+		// queries of a finished batch can't be touched anymore
+		if (index >= batch.size) return;
+
+		ProcessQuery(*batch.snapshot, (*batch.queries)[index]);
+
+		if (++batch.processed == batch.size) {
+			std::unique_lock<std::mutex> lock(mutex);
+			batchFinished.notify_all();
+		}
+	}
+}
+
+void PathQueryPool::ProcessQuery(const MapSnapshot& snapshot, PathQuery& query) {
+	query.path.clear();
+
+	if (query.waypoints.empty()) {
+		SearchGrid(snapshot, query.start, query.end, query.crossForbiddenArea, query.path, query.maxIteration, query.backend);
+		return;
+	}
+
+	// the limit of iterations applies to each segment
+	for (int i = 1; i < query.waypoints.size(); i++) {
+		// the end of one segment is the start of the next one
+		if (i > 1) query.path.pop_back();
+
+		if (!SearchGrid(snapshot, query.waypoints[i - 1], query.waypoints[i], query.crossForbiddenArea, query.path, query.maxIteration, query.backend)) {
+			query.path.clear();
+			return;
+		}
+	}
+}
+
+bool PathQueryPool::SearchGrid(const MapSnapshot& snapshot, Vec2i start, Vec2i end, bool crossForbiddenArea, vector<Vec2i>& output,
+	int maxIteration, PathSearchBackend backend) {
+
+	if (backend == PathSearchBackend::JPS) {
+		// prefer path that avoids forbidden areas
+		auto& search = JumpPointSearch::GetThreadSearch();
+		bool found = search.Search(snapshot, start, end, false, output, maxIteration);
+		if (!found && crossForbiddenArea) {
+			found = search.Search(snapshot, start, end, true, output, maxIteration);
+		}
+		return found;
+	}
+
+	return SearchArena::GetThreadArena().FindPath(snapshot, start, end, crossForbiddenArea, output, maxIteration);
+}
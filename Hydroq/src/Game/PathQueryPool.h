@@ -0,0 +1,142 @@
+#pragma once
+
+#include "Vec2i.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+using namespace Cog;
+
+class MapSnapshot;
+
+// maximal number of threads of the pool (the calling thread is not included)
+#define PATH_QUERY_MAX_THREADS 7
+
+/**
+* Algorithm used for path queries on the grid
+*/
+enum class PathSearchBackend {
+	DEFAULT,	/** backend selected for the whole map */
+	ASTAR,		/** A* search */
+	JPS			/** jump point search */
+};
+
+/**
+* Path query processed in a batch
+*/
+struct PathQuery {
+	// start position
+	Vec2i start;
+	// final position
+	Vec2i end;
+	// if true, forbidden area may be crossed
+	bool crossForbiddenArea = true;
+	// maximal number of expanded tiles (0 for infinite); applies to each segment between waypoints
+	int maxIteration = 0;
+	// search algorithm
+	PathSearchBackend backend = PathSearchBackend::DEFAULT;
+	// abstract path over the hierarchical map the search follows, segment by segment (empty if not used)
+	vector<Vec2i> waypoints;
+	// output path, empty if no path has been found
+	vector<Vec2i> path;
+
+	PathQuery() {
+
+	}
+
+	PathQuery(Vec2i start, Vec2i end, bool crossForbiddenArea, int maxIteration,
+		PathSearchBackend backend = PathSearchBackend::DEFAULT)
+		: start(start), end(end), crossForbiddenArea(crossForbiddenArea), maxIteration(maxIteration), backend(backend) {
+
+	}
+};
+
+/**
+* Pool of threads that process batches of path queries
+*/
+class PathQueryPool {
+private:
+
+	/**
+	* Batch being processed
+	*/
+	struct Batch {
+		// snapshot the queries are searched in
+		spt<MapSnapshot> snapshot;
+		// processed queries
+		vector<PathQuery>* queries;
+		// number of queries
+		int size;
+		// index of the next query to process
+		std::atomic<int> nextQuery;
+		// number of processed queries
+		std::atomic<int> processed;
+	};
+
+	// worker threads
+	vector<std::thread> threads;
+	// lock of the shared state
+	std::mutex mutex;
+	// signals new batch or termination to the threads
+	std::condition_variable batchStarted;
+	// signals the end of the batch to the calling thread
+	std::condition_variable batchFinished;
+	// actual batch
+	spt<Batch> actualBatch;
+	// number of started batches
+	int batchCounter = 0;
+	// if true, the threads will terminate
+	bool terminating = false;
+
+public:
+
+	/**
+	* Creates a new pool
+	* @param threadsNum number of threads; if 0, the number is derived from the number of cores
+	*/
+	PathQueryPool(int threadsNum = 0);
+
+	~PathQueryPool();
+
+	/**
+	* Gets number of threads, including the calling thread
+	*/
+	int GetThreadsNum() const {
+		return threads.size() + 1;
+	}
+
+	/**
+	* Processes all queries and waits until they are finished; the calling thread processes queries as well
+	* @param snapshot snapshot of the map the paths are searched in
+	* @param queries queries to process; the found paths are stored in them
+	*/
+	void Process(spt<MapSnapshot> snapshot, vector<PathQuery>& queries);
+
+private:
+
+	/**
+	* Main loop of a worker thread
+	*/
+	void RunThread();
+
+	/**
+	* Processes queries of a batch until there is none left
+	*/
+	void ProcessBatch(Batch& batch);
+
+	/**
+	* Processes a query; paths avoiding forbidden areas are preferred, as in GameMap::FindPath
+	* If the query has waypoints, each segment between two of them is searched separately
+	* Queries between different components of the map must be rejected by the caller
+	*/
+	static void ProcessQuery(const MapSnapshot& snapshot, PathQuery& query);
+
+	/**
+	* Searches the snapshot with selected backend (A* if the default one hasn't been resolved)
+	* @param output output collection the steps will be appended to, including the start and the end
+	* @return true, if the path has been found
+	*/
+	static bool SearchGrid(const MapSnapshot& snapshot, Vec2i start, Vec2i end, bool crossForbiddenArea, vector<Vec2i>& output,
+		int maxIteration, PathSearchBackend backend);
+};
@@ -0,0 +1,101 @@
+#include "RigDistanceMap.h"
+#include "GameMap.h"
+
+// offsets of neighbors in 4 directions (bridges are built in 4 directions only)
+static const int rigDirX[] = { 0, 1, 0, -1 };
+static const int rigDirY[] = { -1, 0, 1, 0 };
+
+RigDistanceMap::RigDistanceMap(GameMap* gameMap, vector<Vec2i>& sources) : gameMap(gameMap), sources(sources) {
+	Build();
+}
+
+int RigDistanceMap::GetDistance(Vec2i position) {
+	Refresh();
+	return distances[gameMap->GetTileIndex(position)];
+}
+
+Vec2i RigDistanceMap::GetNearestShore(Vec2i position) {
+	Refresh();
+	int shore = shores[gameMap->GetTileIndex(position)];
+	return shore == -1 ? position : gameMap->GetTilePosition(shore);
+}
+
+void RigDistanceMap::OnTileChanged(int index) {
+	if (GetTileCost(index) == 0) {
+		builtTiles.push_back(index);
+	}
+	else {
+		needsRebuild = true;
+	}
+}
+
+int RigDistanceMap::GetTileCost(int index) const {
+	return gameMap->GetTileType(index) == MapTileType::WATER ? 1 : 0;
+}
+
+void RigDistanceMap::Build() {
+	int size = gameMap->GetWidth()*gameMap->GetHeight();
+	distances.assign(size, MAP_INFINITE_COST);
+	shores.assign(size, -1);
+	builtTiles.clear();
+	needsRebuild = false;
+
+	OpenList openList;
+	for (auto& source : sources) {
+		int index = gameMap->GetTileIndex(source);
+		distances[index] = 0;
+		shores[index] = index;
+		openList.push(make_pair(0, index));
+	}
+
+	Propagate(openList);
+}
+
+void RigDistanceMap::Refresh() {
+	if (needsRebuild) {
+		// a bridge has been destroyed -> distances may grow
+		Build();
+		return;
+	}
+
+	if (builtTiles.empty()) return;
+
+	// a new bridge can only shorten the distances
+	OpenList openList;
+	for (int tile : builtTiles) {
+		for (int i = 0; i < 4; i++) {
+			int neighbor = gameMap->GetNeighborIndex(tile, rigDirX[i], rigDirY[i]);
+			if (neighbor == -1 || distances[neighbor] >= distances[tile]) continue;
+
+			// the tile costs nothing now -> it gets the distance of its neighbor
+			distances[tile] = distances[neighbor];
+			shores[tile] = distances[tile] == 0 ? tile : shores[neighbor];
+			openList.push(make_pair(distances[tile], tile));
+		}
+	}
+	builtTiles.clear();
+
+	Propagate(openList);
+}
+
+void RigDistanceMap::Propagate(OpenList& openList) {
+	while (!openList.empty()) {
+		auto top = openList.top();
+		openList.pop();
+		int actual = top.second;
+		if (top.first > distances[actual]) continue;
+
+		for (int i = 0; i < 4; i++) {
+			int neighbor = gameMap->GetNeighborIndex(actual, rigDirX[i], rigDirY[i]);
+			if (neighbor == -1) continue;
+
+			int distance = top.first + GetTileCost(neighbor);
+			if (distance < distances[neighbor]) {
+				distances[neighbor] = distance;
+				// the shore is the last tile reachable without bridges
+				shores[neighbor] = distance == 0 ? neighbor : (top.first == 0 ? actual : shores[actual]);
+				openList.push(make_pair(distance, neighbor));
+			}
+		}
+	}
+}
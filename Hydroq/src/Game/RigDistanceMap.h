@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Vec2i.h"
+#include <queue>
+
+using namespace Cog;
+
+class GameMap;
+
+/**
+* Distance map from a group of rigs (e.g. all rigs of one faction); for each tile it holds
+* the number of water tiles that must be bridged to get there from any of the rigs,
+* and the nearest reachable shore tile the bridge should start from
+* Built by a multi-source search and updated incrementally when bridges are built
+*/
+class RigDistanceMap {
+private:
+	// open list of the search (pairs of distance and tile index, the nearest at the top)
+	typedef priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> OpenList;
+
+	// link to the map
+	GameMap* gameMap;
+	// positions the search starts at
+	vector<Vec2i> sources;
+	// number of water tiles to bridge, for each tile
+	vector<int> distances;
+	// index of the reachable tile the bridge should start from, for each tile
+	vector<int> shores;
+	// tiles that have become land since the last access
+	vector<int> builtTiles;
+	// indicator whether a tile has become water since the last access (the map must be recalculated)
+	bool needsRebuild = false;
+
+public:
+
+	/**
+	* Creates a new distance map
+	* @param sources positions of rigs the distances are measured from
+	*/
+	RigDistanceMap(GameMap* gameMap, vector<Vec2i>& sources);
+
+	/**
+	* Gets positions the distances are measured from
+	*/
+	const vector<Vec2i>& GetSources() const {
+		return sources;
+	}
+
+	/**
+	* Gets number of water tiles that must be bridged to get to selected position
+	* (0 if the position can be reached, MAP_INFINITE_COST if there are no sources)
+	*/
+	int GetDistance(Vec2i position);
+
+	/**
+	* Gets the nearest reachable tile the bridge leading to selected position should start from;
+	* if the position can be reached, returns the position itself
+	*/
+	Vec2i GetNearestShore(Vec2i position);
+
+	/**
+	* Notifies the map that a tile has changed; the map is updated on the next access
+	*/
+	void OnTileChanged(int index);
+
+private:
+
+	/**
+	* Gets cost of entering selected tile (1 for water, 0 otherwise)
+	*/
+	int GetTileCost(int index) const;
+
+	/**
+	* Calculates the whole map
+	*/
+	void Build();
+
+	/**
+	* Applies changes of the map
+	*/
+	void Refresh();
+
+	/**
+	* Propagates distances from the tiles in the open list
+	*/
+	void Propagate(OpenList& openList);
+};
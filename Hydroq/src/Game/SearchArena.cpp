@@ -0,0 +1,21 @@
+#include "SearchArena.h"
+#include <climits>
+
+SearchArena& SearchArena::GetThreadArena() {
+	static thread_local SearchArena arena;
+	return arena;
+}
+
+void SearchArena::Prepare(int size) {
+	if (stamps.size() != size || searchStamp == INT_MAX) {
+		// the first search over this map
+		stamps.assign(size, 0);
+		costs.assign(size, 0);
+		parents.assign(size, -1);
+		closed.assign(size, 0);
+		searchStamp = 0;
+	}
+
+	searchStamp++;
+	openList.clear();
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "Vec2i.h"
+#include "GameMap.h"
+#include <algorithm>
+
+using namespace Cog;
+
+/**
+* Reusable buffers of the A* search over a grid of tiles; all arrays are sized to the map
+* and stamped by the search that wrote them, so that starting a new search doesn't need
+* to clear anything and no memory is allocated once the arena has grown to the map size
+* Each thread has its own arena, see GetThreadArena
+*
+* The grid must provide GetWidth(), GetHeight(), IsPassable(x, y, crossForbiddenArea),
+* GetStepCost(index, dirX, dirY, crossForbiddenArea) and CalcHeuristic(from, to)
+* If the forbidden area may be crossed, forbidden tiles carry MAP_FORBIDDEN_PENALTY, so that
+* one search prefers paths around the area and crosses it only if there is no other way
+* The penalty makes the search expand many more tiles before it steps into the area, hence
+* if the iterations run out, the search is repeated without the penalty with a fresh limit
+*/
+class SearchArena {
+private:
+	// stamp of the actual search
+	int searchStamp = 0;
+	// stamp of the search that has reached each tile
+	vector<int> stamps;
+	// cost from the start, valid for tiles with actual stamp
+	vector<int> costs;
+	// previous tile, valid for tiles with actual stamp
+	vector<int> parents;
+	// indicator whether the tile has already been expanded (valid for tiles with actual stamp)
+	vector<unsigned char> closed;
+	// binary heap of pairs of estimated cost and tile index
+	vector<pair<int, int>> openList;
+	// indicator whether the last search has run out of iterations
+	bool iterationsExceeded = false;
+
+public:
+
+	/**
+	* Gets arena of the calling thread
+	*/
+	static SearchArena& GetThreadArena();
+
+	/**
+	* Finds path from start to end
+	* @param crossForbiddenArea if true, forbidden tiles are passable with a penalty
+	* @param output output collection of steps, including the start and the end
+	* @param maxIteration maximal number of expanded tiles (0 for infinite); applies to each search separately
+	* @return true, if the path has been found
+	*/
+	template<class Grid>
+	bool FindPath(const Grid& grid, Vec2i start, Vec2i end, bool crossForbiddenArea, vector<Vec2i>& output, int maxIteration) {
+		int width = grid.GetWidth();
+		if (!grid.IsPassable(end.x, end.y, crossForbiddenArea)) return false;
+
+		int goal = end.y*width + end.x;
+		bool found = Search(grid, start.y*width + start.x, goal, crossForbiddenArea, maxIteration, true);
+
+		if (!found && crossForbiddenArea && iterationsExceeded) {
+			// the way around the forbidden area has used up the limit -> cross the area as if it were free
+			found = Search(grid, start.y*width + start.x, goal, crossForbiddenArea, maxIteration, false);
+		}
+
+		if (!found) return false;
+
+		int offset = output.size();
+		for (int tile = goal; tile != -1; tile = parents[tile]) {
+			output.push_back(Vec2i(tile % width, tile / width));
+		}
+		reverse(output.begin() + offset, output.end());
+		return true;
+	}
+
+private:
+
+	/**
+	* Starts a new search over a map of selected size
+	*/
+	void Prepare(int size);
+
+	/**
+	* A* search; parents of tiles reached by the search are kept in the arena
+	* @param weighForbidden if false, forbidden tiles cost as much as other tiles
+	* @return true, if the goal has been reached
+	*/
+	template<class Grid>
+	bool Search(const Grid& grid, int start, int goal, bool crossForbiddenArea, int maxIteration, bool weighForbidden) {
+		// offsets of neighbors in 8 directions
+		static const int dirX[] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+		static const int dirY[] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+
+		int width = grid.GetWidth();
+		Prepare(width*grid.GetHeight());
+
+		stamps[start] = searchStamp;
+		costs[start] = 0;
+		parents[start] = -1;
+		closed[start] = 0;
+		openList.push_back(make_pair(grid.CalcHeuristic(start, goal), start));
+
+		int iterations = 0;
+		iterationsExceeded = false;
+
+		while (!openList.empty()) {
+			pop_heap(openList.begin(), openList.end(), greater<pair<int, int>>());
+			int actual = openList.back().second;
+			openList.pop_back();
+
+			if (closed[actual]) continue;
+			closed[actual] = 1;
+
+			if (actual == goal) {
+				return true;
+			}
+
+			if (maxIteration != 0 && iterations++ >= maxIteration) {
+				iterationsExceeded = true;
+				return false;
+			}
+
+			for (int i = 0; i < 8; i++) {
+				int stepCost = grid.GetStepCost(actual, dirX[i], dirY[i], crossForbiddenArea);
+				if (stepCost == -1) continue;
+				if (!weighForbidden && stepCost >= MAP_FORBIDDEN_PENALTY) stepCost -= MAP_FORBIDDEN_PENALTY;
+
+				int neighbor = actual + dirY[i] * width + dirX[i];
+				int cost = costs[actual] + stepCost;
+
+				if (stamps[neighbor] != searchStamp) {
+					stamps[neighbor] = searchStamp;
+					closed[neighbor] = 0;
+				}
+				else if (closed[neighbor] || costs[neighbor] <= cost) {
+					continue;
+				}
+
+				costs[neighbor] = cost;
+				parents[neighbor] = actual;
+				openList.push_back(make_pair(cost + grid.CalcHeuristic(neighbor, goal), neighbor));
+				push_heap(openList.begin(), openList.end(), greater<pair<int, int>>());
+			}
+		}
+
+		return false;
+	}
+};
@@ -0,0 +1,118 @@
+#include "SteeringBenchmark.h"
+#include "SteeringKernel.h"
+#include "WorkerSystem.h"
+#include "SteeringBehavior.h"
+#include "Move.h"
+#include "Node.h"
+#include <random>
+
+void SteeringBenchmark::Run(float maxAcceleration, float maxRadialAcceleration, int units, int frames, int seed) {
+	// the first point of each path is the starting position of the unit
+	std::mt19937 random(seed);
+	vector<ofVec2f> points;
+	for (int i = 0; i < units; i++) {
+		ofVec2f point = ofVec2f(random() % 100 + 0.5f, random() % 100 + 0.5f);
+		for (int j = 0; j < STEERING_BENCHMARK_PATH_POINTS; j++) {
+			points.push_back(point);
+			point += ofVec2f((int)(random() % 3) - 1.0f, (int)(random() % 3) - 1.0f);
+		}
+	}
+
+	uint64 nodesTime = RunNodes(points, units, frames, maxAcceleration, maxRadialAcceleration);
+	uint64 lanesTime = RunKernel(points, units, frames, maxAcceleration, maxRadialAcceleration, true);
+	uint64 scalarTime = RunKernel(points, units, frames, maxAcceleration, maxRadialAcceleration, false);
+
+	CogLogInfo("Hydroq", "Steering benchmark (%d units, %d frames): nodes %d us, kernel (%s) %d us, scalar kernel %d us",
+		units, frames, (int)nodesTime, SteeringKernel::GetInstructionSet(), (int)lanesTime, (int)scalarTime);
+}
+
+uint64 SteeringBenchmark::RunNodes(vector<ofVec2f>& points, int units, int frames, float maxAcceleration, float maxRadialAcceleration) {
+	Node* root = new Node("steering_benchmark");
+	vector<Node*> nodes;
+
+	for (int i = 0; i < units; i++) {
+		auto unitPoints = &points[i*STEERING_BENCHMARK_PATH_POINTS];
+		Path* path = new Path(unitPoints[0], unitPoints[1]);
+		for (int j = 2; j < STEERING_BENCHMARK_PATH_POINTS; j++) {
+			path->AddSegment(unitPoints[j]);
+		}
+
+		Node* node = new Node("unit");
+		node->GetTransform().localPos.x = unitPoints[0].x;
+		node->GetTransform().localPos.y = unitPoints[0].y;
+		node->AddBehavior(new FollowBehavior(path, maxAcceleration, maxRadialAcceleration, WORKER_POINT_TOLERANCE, WORKER_FINAL_TOLERANCE));
+		node->AddBehavior(new Move());
+		root->AddChild(node);
+		nodes.push_back(node);
+	}
+
+	root->SubmitChanges(true);
+
+	uint64 startTime = ofGetElapsedTimeMicros();
+	for (int i = 0; i < frames; i++) {
+		root->Update(STEERING_BENCHMARK_DELTA, (i + 1)*STEERING_BENCHMARK_DELTA);
+	}
+	uint64 time = ofGetElapsedTimeMicros() - startTime;
+
+	for (auto node : nodes) {
+		root->RemoveChild(node, true);
+	}
+	delete root;
+
+	return time;
+}
+
+uint64 SteeringBenchmark::RunKernel(vector<ofVec2f>& points, int units, int frames, float maxAcceleration, float maxRadialAcceleration, bool useLanes) {
+	SteeringParams params;
+	params.maxSpeed = WORKER_MAX_SPEED;
+	params.maxAcceleration = maxAcceleration;
+	params.maxRadialAcceleration = maxRadialAcceleration;
+	params.arriveRadius = WORKER_ARRIVE_RADIUS;
+
+	SteeringData data;
+	vector<int> nextPoints(units, 1);
+	for (int i = 0; i < units; i++) {
+		auto& start = points[i*STEERING_BENCHMARK_PATH_POINTS];
+		data.Add(start.x, start.y);
+		data.targetsX[i] = points[i*STEERING_BENCHMARK_PATH_POINTS + 1].x;
+		data.targetsY[i] = points[i*STEERING_BENCHMARK_PATH_POINTS + 1].y;
+		data.speeds[i] = WORKER_MAX_SPEED;
+	}
+
+	float deltaTime = STEERING_BENCHMARK_DELTA / 1000.0f;
+
+	uint64 startTime = ofGetElapsedTimeMicros();
+	for (int i = 0; i < frames; i++) {
+		// move to the next point of the path, the same way WorkerSystem does
+		for (int j = 0; j < units; j++) {
+			int& next = nextPoints[j];
+			if (next == STEERING_BENCHMARK_PATH_POINTS) continue;
+
+			bool isLastPoint = next == STEERING_BENCHMARK_PATH_POINTS - 1;
+			auto& point = points[j*STEERING_BENCHMARK_PATH_POINTS + next];
+			float distance = point.distance(ofVec2f(data.positionsX[j], data.positionsY[j]));
+
+			if (distance < (isLastPoint ? WORKER_FINAL_TOLERANCE : WORKER_POINT_TOLERANCE)) {
+				next++;
+				if (isLastPoint) {
+					data.velocitiesX[j] = data.velocitiesY[j] = data.speeds[j] = 0;
+				}
+				else {
+					auto& nextPoint = points[j*STEERING_BENCHMARK_PATH_POINTS + next];
+					data.targetsX[j] = nextPoint.x;
+					data.targetsY[j] = nextPoint.y;
+					data.arrivals[j] = next == STEERING_BENCHMARK_PATH_POINTS - 1 ? 1.0f : 0.0f;
+				}
+			}
+		}
+
+		if (useLanes) {
+			SteeringKernel::Integrate(data, params, deltaTime);
+		}
+		else {
+			SteeringKernel::IntegrateScalar(data, params, deltaTime);
+		}
+	}
+
+	return ofGetElapsedTimeMicros() - startTime;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Vec2i.h"
+
+using namespace Cog;
+
+// default number of units
+#define STEERING_BENCHMARK_UNITS 10000
+// default number of simulated frames
+#define STEERING_BENCHMARK_FRAMES 300
+// number of points of the path of each unit
+#define STEERING_BENCHMARK_PATH_POINTS 8
+// duration of a simulated frame [ms]
+#define STEERING_BENCHMARK_DELTA 16
+
+/**
+* Benchmark of unit movement; the same units follow the same paths once by nodes
+* with FollowBehavior and Move, once by the steering kernel with packed lanes and once
+* by its scalar version, and the times are logged
+* Enabled by steering_benchmark setting in config.xml
+*/
+class SteeringBenchmark {
+public:
+
+	/**
+	* Runs the benchmark
+	* @param maxAcceleration maximal acceleration of units
+	* @param maxRadialAcceleration maximal radial acceleration of units
+	* @param units number of units
+	* @param frames number of simulated frames
+	* @param seed seed of the random generator of paths
+	*/
+	static void Run(float maxAcceleration, float maxRadialAcceleration, int units = STEERING_BENCHMARK_UNITS,
+		int frames = STEERING_BENCHMARK_FRAMES, int seed = 0);
+
+private:
+
+	/**
+	* Moves units by nodes with steering behaviors
+	* @return elapsed time [us]
+	*/
+	static uint64 RunNodes(vector<ofVec2f>& points, int units, int frames, float maxAcceleration, float maxRadialAcceleration);
+
+	/**
+	* Moves units by the steering kernel
+	* @param useLanes if false, the scalar version of the kernel is used
+	* @return elapsed time [us]
+	*/
+	static uint64 RunKernel(vector<ofVec2f>& points, int units, int frames, float maxAcceleration, float maxRadialAcceleration, bool useLanes);
+};
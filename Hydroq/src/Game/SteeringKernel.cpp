@@ -0,0 +1,223 @@
+#include "SteeringKernel.h"
+
+#if defined(STEERING_KERNEL_AVX)
+#include <immintrin.h>
+#elif defined(STEERING_KERNEL_SSE)
+#include <emmintrin.h>
+#endif
+
+void SteeringData::Add(float x, float y) {
+	positionsX.push_back(x);
+	positionsY.push_back(y);
+	velocitiesX.push_back(0);
+	velocitiesY.push_back(0);
+	targetsX.push_back(x);
+	targetsY.push_back(y);
+	speeds.push_back(0);
+	arrivals.push_back(0);
+	separationsX.push_back(0);
+	separationsY.push_back(0);
+}
+
+void SteeringKernel::Integrate(SteeringData& data, const SteeringParams& params, float deltaTime) {
+#if defined(STEERING_KERNEL_AVX)
+	int processed = IntegrateAVX(data, params, deltaTime);
+#elif defined(STEERING_KERNEL_SSE)
+	int processed = IntegrateSSE(data, params, deltaTime);
+#else
+	int processed = 0;
+#endif
+	// the rest that doesn't fill the whole register
+	IntegrateScalar(data, params, deltaTime, processed);
+}
+
+void SteeringKernel::IntegrateScalar(SteeringData& data, const SteeringParams& params, float deltaTime, int from) {
+	int size = data.Size();
+
+	for (int i = from; i < size; i++) {
+		float px = data.positionsX[i];
+		float py = data.positionsY[i];
+		float vx = data.velocitiesX[i];
+		float vy = data.velocitiesY[i];
+
+		// seek the target, slow down when arriving at it, keep apart from other units
+		float dx = data.targetsX[i] - px;
+		float dy = data.targetsY[i] - py;
+		float distance = sqrtf(dx*dx + dy*dy);
+		float arriveScale = min(1.0f, distance / params.arriveRadius);
+		float desired = data.speeds[i] * (1.0f + data.arrivals[i] * (arriveScale - 1.0f)) / max(distance, STEERING_EPSILON);
+		float sx = dx*desired - vx + data.separationsX[i];
+		float sy = dy*desired - vy + data.separationsY[i];
+
+		// limit the part of the steering force that turns the unit
+		float speed = sqrtf(vx*vx + vy*vy);
+		float dirX = vx / max(speed, STEERING_EPSILON);
+		float dirY = vy / max(speed, STEERING_EPSILON);
+		float tangential = sx*dirX + sy*dirY;
+		float rx = sx - dirX*tangential;
+		float ry = sy - dirY*tangential;
+		float radialSize = sqrtf(rx*rx + ry*ry);
+		float radialScale = speed > STEERING_EPSILON ? min(1.0f, params.maxRadialAcceleration / max(radialSize, STEERING_EPSILON)) : 1.0f;
+		sx = dirX*tangential + rx*radialScale;
+		sy = dirY*tangential + ry*radialScale;
+
+		// limit the whole force
+		float steeringSize = sqrtf(sx*sx + sy*sy);
+		float accelerationScale = min(1.0f, params.maxAcceleration / max(steeringSize, STEERING_EPSILON)) * deltaTime;
+		vx += sx*accelerationScale;
+		vy += sy*accelerationScale;
+
+		// limit the speed
+		speed = sqrtf(vx*vx + vy*vy);
+		float speedScale = min(1.0f, params.maxSpeed / max(speed, STEERING_EPSILON));
+		vx *= speedScale;
+		vy *= speedScale;
+
+		data.velocitiesX[i] = vx;
+		data.velocitiesY[i] = vy;
+		data.positionsX[i] = px + vx*deltaTime;
+		data.positionsY[i] = py + vy*deltaTime;
+	}
+}
+
+const char* SteeringKernel::GetInstructionSet() {
+#if defined(STEERING_KERNEL_AVX)
+	return "AVX";
+#elif defined(STEERING_KERNEL_SSE)
+	return "SSE";
+#else
+	return "scalar";
+#endif
+}
+
+#if defined(STEERING_KERNEL_AVX)
+
+int SteeringKernel::IntegrateAVX(SteeringData& data, const SteeringParams& params, float deltaTime) {
+	int size = data.Size() - data.Size() % 8;
+
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 epsilon = _mm256_set1_ps(STEERING_EPSILON);
+	const __m256 arriveRadius = _mm256_set1_ps(params.arriveRadius);
+	const __m256 maxRadialAcc = _mm256_set1_ps(params.maxRadialAcceleration);
+	const __m256 maxAcc = _mm256_set1_ps(params.maxAcceleration);
+	const __m256 maxSpeed = _mm256_set1_ps(params.maxSpeed);
+	const __m256 dt = _mm256_set1_ps(deltaTime);
+
+	for (int i = 0; i < size; i += 8) {
+		__m256 px = _mm256_loadu_ps(&data.positionsX[i]);
+		__m256 py = _mm256_loadu_ps(&data.positionsY[i]);
+		__m256 vx = _mm256_loadu_ps(&data.velocitiesX[i]);
+		__m256 vy = _mm256_loadu_ps(&data.velocitiesY[i]);
+
+		// seek the target, slow down when arriving at it, keep apart from other units
+		__m256 dx = _mm256_sub_ps(_mm256_loadu_ps(&data.targetsX[i]), px);
+		__m256 dy = _mm256_sub_ps(_mm256_loadu_ps(&data.targetsY[i]), py);
+		__m256 distance = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+		__m256 arriveScale = _mm256_min_ps(one, _mm256_div_ps(distance, arriveRadius));
+		__m256 speedScale = _mm256_add_ps(one, _mm256_mul_ps(_mm256_loadu_ps(&data.arrivals[i]), _mm256_sub_ps(arriveScale, one)));
+		__m256 desired = _mm256_div_ps(_mm256_mul_ps(_mm256_loadu_ps(&data.speeds[i]), speedScale), _mm256_max_ps(distance, epsilon));
+		__m256 sx = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(dx, desired), vx), _mm256_loadu_ps(&data.separationsX[i]));
+		__m256 sy = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(dy, desired), vy), _mm256_loadu_ps(&data.separationsY[i]));
+
+		// limit the part of the steering force that turns the unit
+		__m256 speed = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy)));
+		__m256 safeSpeed = _mm256_max_ps(speed, epsilon);
+		__m256 dirX = _mm256_div_ps(vx, safeSpeed);
+		__m256 dirY = _mm256_div_ps(vy, safeSpeed);
+		__m256 tangential = _mm256_add_ps(_mm256_mul_ps(sx, dirX), _mm256_mul_ps(sy, dirY));
+		__m256 rx = _mm256_sub_ps(sx, _mm256_mul_ps(dirX, tangential));
+		__m256 ry = _mm256_sub_ps(sy, _mm256_mul_ps(dirY, tangential));
+		__m256 radialSize = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(rx, rx), _mm256_mul_ps(ry, ry)));
+		__m256 radialScale = _mm256_min_ps(one, _mm256_div_ps(maxRadialAcc, _mm256_max_ps(radialSize, epsilon)));
+		radialScale = _mm256_blendv_ps(one, radialScale, _mm256_cmp_ps(speed, epsilon, _CMP_GT_OQ));
+		sx = _mm256_add_ps(_mm256_mul_ps(dirX, tangential), _mm256_mul_ps(rx, radialScale));
+		sy = _mm256_add_ps(_mm256_mul_ps(dirY, tangential), _mm256_mul_ps(ry, radialScale));
+
+		// limit the whole force
+		__m256 steeringSize = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(sx, sx), _mm256_mul_ps(sy, sy)));
+		__m256 accelerationScale = _mm256_mul_ps(_mm256_min_ps(one, _mm256_div_ps(maxAcc, _mm256_max_ps(steeringSize, epsilon))), dt);
+		vx = _mm256_add_ps(vx, _mm256_mul_ps(sx, accelerationScale));
+		vy = _mm256_add_ps(vy, _mm256_mul_ps(sy, accelerationScale));
+
+		// limit the speed
+		speed = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy)));
+		speedScale = _mm256_min_ps(one, _mm256_div_ps(maxSpeed, _mm256_max_ps(speed, epsilon)));
+		vx = _mm256_mul_ps(vx, speedScale);
+		vy = _mm256_mul_ps(vy, speedScale);
+
+		_mm256_storeu_ps(&data.velocitiesX[i], vx);
+		_mm256_storeu_ps(&data.velocitiesY[i], vy);
+		_mm256_storeu_ps(&data.positionsX[i], _mm256_add_ps(px, _mm256_mul_ps(vx, dt)));
+		_mm256_storeu_ps(&data.positionsY[i], _mm256_add_ps(py, _mm256_mul_ps(vy, dt)));
+	}
+
+	return size;
+}
+
+#elif defined(STEERING_KERNEL_SSE)
+
+int SteeringKernel::IntegrateSSE(SteeringData& data, const SteeringParams& params, float deltaTime) {
+	int size = data.Size() - data.Size() % 4;
+
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 epsilon = _mm_set1_ps(STEERING_EPSILON);
+	const __m128 arriveRadius = _mm_set1_ps(params.arriveRadius);
+	const __m128 maxRadialAcc = _mm_set1_ps(params.maxRadialAcceleration);
+	const __m128 maxAcc = _mm_set1_ps(params.maxAcceleration);
+	const __m128 maxSpeed = _mm_set1_ps(params.maxSpeed);
+	const __m128 dt = _mm_set1_ps(deltaTime);
+
+	for (int i = 0; i < size; i += 4) {
+		__m128 px = _mm_loadu_ps(&data.positionsX[i]);
+		__m128 py = _mm_loadu_ps(&data.positionsY[i]);
+		__m128 vx = _mm_loadu_ps(&data.velocitiesX[i]);
+		__m128 vy = _mm_loadu_ps(&data.velocitiesY[i]);
+
+		// seek the target, slow down when arriving at it, keep apart from other units
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(&data.targetsX[i]), px);
+		__m128 dy = _mm_sub_ps(_mm_loadu_ps(&data.targetsY[i]), py);
+		__m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+		__m128 arriveScale = _mm_min_ps(one, _mm_div_ps(distance, arriveRadius));
+		__m128 speedScale = _mm_add_ps(one, _mm_mul_ps(_mm_loadu_ps(&data.arrivals[i]), _mm_sub_ps(arriveScale, one)));
+		__m128 desired = _mm_div_ps(_mm_mul_ps(_mm_loadu_ps(&data.speeds[i]), speedScale), _mm_max_ps(distance, epsilon));
+		__m128 sx = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(dx, desired), vx), _mm_loadu_ps(&data.separationsX[i]));
+		__m128 sy = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(dy, desired), vy), _mm_loadu_ps(&data.separationsY[i]));
+
+		// limit the part of the steering force that turns the unit
+		__m128 speed = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)));
+		__m128 safeSpeed = _mm_max_ps(speed, epsilon);
+		__m128 dirX = _mm_div_ps(vx, safeSpeed);
+		__m128 dirY = _mm_div_ps(vy, safeSpeed);
+		__m128 tangential = _mm_add_ps(_mm_mul_ps(sx, dirX), _mm_mul_ps(sy, dirY));
+		__m128 rx = _mm_sub_ps(sx, _mm_mul_ps(dirX, tangential));
+		__m128 ry = _mm_sub_ps(sy, _mm_mul_ps(dirY, tangential));
+		__m128 radialSize = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)));
+		__m128 radialScale = _mm_min_ps(one, _mm_div_ps(maxRadialAcc, _mm_max_ps(radialSize, epsilon)));
+		// SSE2 has no blend, the lanes are selected by masking
+		__m128 moving = _mm_cmpgt_ps(speed, epsilon);
+		radialScale = _mm_or_ps(_mm_and_ps(moving, radialScale), _mm_andnot_ps(moving, one));
+		sx = _mm_add_ps(_mm_mul_ps(dirX, tangential), _mm_mul_ps(rx, radialScale));
+		sy = _mm_add_ps(_mm_mul_ps(dirY, tangential), _mm_mul_ps(ry, radialScale));
+
+		// limit the whole force
+		__m128 steeringSize = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(sx, sx), _mm_mul_ps(sy, sy)));
+		__m128 accelerationScale = _mm_mul_ps(_mm_min_ps(one, _mm_div_ps(maxAcc, _mm_max_ps(steeringSize, epsilon))), dt);
+		vx = _mm_add_ps(vx, _mm_mul_ps(sx, accelerationScale));
+		vy = _mm_add_ps(vy, _mm_mul_ps(sy, accelerationScale));
+
+		// limit the speed
+		speed = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)));
+		speedScale = _mm_min_ps(one, _mm_div_ps(maxSpeed, _mm_max_ps(speed, epsilon)));
+		vx = _mm_mul_ps(vx, speedScale);
+		vy = _mm_mul_ps(vy, speedScale);
+
+		_mm_storeu_ps(&data.velocitiesX[i], vx);
+		_mm_storeu_ps(&data.velocitiesY[i], vy);
+		_mm_storeu_ps(&data.positionsX[i], _mm_add_ps(px, _mm_mul_ps(vx, dt)));
+		_mm_storeu_ps(&data.positionsY[i], _mm_add_ps(py, _mm_mul_ps(vy, dt)));
+	}
+
+	return size;
+}
+
+#endif
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Vec2i.h"
+
+using namespace Cog;
+
+// instruction set the steering kernel is compiled for; the scalar version is used otherwise
+#if defined(__AVX__)
+#define STEERING_KERNEL_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STEERING_KERNEL_SSE
+#endif
+
+// lengths below this value are considered as zero
+#define STEERING_EPSILON 0.00001f
+
+/**
+* Limits of the steering
+*/
+struct SteeringParams {
+	// maximal speed [tiles/s]
+	float maxSpeed = 0;
+	// maximal acceleration [tiles/s^2]
+	float maxAcceleration = 0;
+	// maximal acceleration perpendicular to the direction of movement [tiles/s^2]
+	float maxRadialAcceleration = 0;
+	// distance from a target at which units start to slow down if they should arrive at it [tiles]
+	float arriveRadius = 0;
+};
+
+/**
+* Movement data of units, each value in its own array so that the kernel can load several units at once
+*/
+struct SteeringData {
+	// horizontal positions
+	vector<float> positionsX;
+	// vertical positions
+	vector<float> positionsY;
+	// horizontal velocities
+	vector<float> velocitiesX;
+	// vertical velocities
+	vector<float> velocitiesY;
+	// horizontal positions of targets
+	vector<float> targetsX;
+	// vertical positions of targets
+	vector<float> targetsY;
+	// desired speeds; units with zero speed stop
+	vector<float> speeds;
+	// 1 if a unit should slow down when approaching its target, 0 if it should pass through
+	vector<float> arrivals;
+	// horizontal forces that keep units apart from each other
+	vector<float> separationsX;
+	// vertical forces that keep units apart from each other
+	vector<float> separationsY;
+
+	/**
+	* Adds a new unit that stands at selected position
+	*/
+	void Add(float x, float y);
+
+	/**
+	* Gets number of units
+	*/
+	int Size() const {
+		return positionsX.size();
+	}
+};
+
+/**
+* Kernel that steers units towards their targets and integrates their movement,
+* processing several units in packed float lanes (AVX, SSE) or one by one if neither is available
+*/
+class SteeringKernel {
+public:
+
+	/**
+	* Steers all units and moves them
+	* @param deltaTime time step [s]
+	*/
+	static void Integrate(SteeringData& data, const SteeringParams& params, float deltaTime);
+
+	/**
+	* Steers and moves units one by one, starting at selected index
+	*/
+	static void IntegrateScalar(SteeringData& data, const SteeringParams& params, float deltaTime, int from = 0);
+
+	/**
+	* Gets name of the instruction set the kernel uses
+	*/
+	static const char* GetInstructionSet();
+
+private:
+
+#if defined(STEERING_KERNEL_AVX)
+	/**
+	* Steers and moves units in groups of 8
+	* @return number of processed units
+	*/
+	static int IntegrateAVX(SteeringData& data, const SteeringParams& params, float deltaTime);
+#elif defined(STEERING_KERNEL_SSE)
+	/**
+	* Steers and moves units in groups of 4
+	* @return number of processed units
+	*/
+	static int IntegrateSSE(SteeringData& data, const SteeringParams& params, float deltaTime);
+#endif
+};
@@ -5,194 +5,404 @@ void TaskScheduler::CalcAssignedTasks(vector<spt<GameTask>>& tasks, map<int, int
 	
 	for (auto& task : tasks) {
 		if (task->IsReserved()) {
-			for (auto node : task->GetReservedNodes()) {
-				if (output.find(node->GetId()) == output.end()) {
-					output[node->GetId()] = 0;
+			for (int workerId : task->GetReservedWorkers()) {
+				if (output.find(workerId) == output.end()) {
+					output[workerId] = 0;
 				}
 				else {
-					output[node->GetId()] += 1;
+					output[workerId] += 1;
 				}
 			}
 		}
 	}
 }
 
+void TaskScheduler::OnInit() {
+	playerModel = GETCOMPONENT(PlayerModel);
+	SubscribeForMessages(ACT_SCHEDULING_CHANGED);
+
+	auto& settings = CogGetProjectSettings();
+	int configuredBudget = settings.GetSettingValInt("hydroq_set", "scheduler_budget");
+	if (configuredBudget > 0) {
+		budget = configuredBudget;
+	}
+}
+
+void TaskScheduler::OnMessage(Msg& msg) {
+	if (msg.HasAction(ACT_SCHEDULING_CHANGED)) {
+		auto evt = msg.GetData<SchedulingChangedEvent>();
+
+		if (evt->changeType == SchedulingChangeType::TASK_CREATED) {
+			// only the new task is affected; tasks of the other player aren't scheduled in multiplayer
+			if (!playerModel->IsMultiplayer() || evt->faction == playerModel->GetFaction()) {
+				dirtyTasks[evt->faction].push_back(evt->task->GetHandle());
+			}
+		}
+		else if (evt->changeType == SchedulingChangeType::PLATFORM_BUILT) {
+			// delayed tasks of both factions may be reachable now
+			dirtyFactions.insert(Faction::BLUE);
+			dirtyFactions.insert(Faction::RED);
+		}
+		else {
+			// a worker is available or the shares of attractors have changed -> any waiting task of the faction may be assigned
+			dirtyFactions.insert(evt->faction);
+		}
+	}
+}
+
 void TaskScheduler::ScheduleTasks(uint64 absolute) {
+	if (job.phase == SchedulingPhase::IDLE && !StartJob(absolute)) {
+		// nothing has changed
+		return;
+	}
+
+	COGMEASURE_BEGIN("HYDROQ_SCHEDULER");
+
+	uint64 deadline = ofGetElapsedTimeMicros() + budget;
+
+	// at least one step is processed in each frame
+	do {
+		ProcessJobStep(absolute);
+
+		if (job.phase == SchedulingPhase::IDLE && !StartJob(absolute)) {
+			break;
+		}
+	} while (ofGetElapsedTimeMicros() < deadline);
+
+	COGMEASURE_END("HYDROQ_SCHEDULER");
+}
+
+bool TaskScheduler::StartJob(uint64 absolute) {
 	if (playerModel->IsMultiplayer()) {
-		ScheduleTasksForFaction(absolute, playerModel->GetFaction());
+		return StartJob(absolute, playerModel->GetFaction());
 	}
 	else {
-		ScheduleTasksForFaction(absolute, Faction::BLUE);
-		ScheduleTasksForFaction(absolute, Faction::RED);
+		// factions take turns
+		Faction first = job.faction == Faction::BLUE ? Faction::RED : Faction::BLUE;
+		Faction second = first == Faction::BLUE ? Faction::RED : Faction::BLUE;
+		return StartJob(absolute, first) || StartJob(absolute, second);
 	}
 }
 
-void TaskScheduler::ScheduleTasksForFaction(uint64 absolute, Faction faction) {
-	vector<spt<GameTask>> allTasks;
-	gameModel->GetGameTasksByFaction(faction, allTasks);
-	
-	vector<Node*> allWorkers;
-	gameModel->GetMovingObjectsByType(EntityType::WORKER, faction, allWorkers);
-	auto map = gameModel->GetMap();
+bool TaskScheduler::StartJob(uint64 absolute, Faction faction) {
+	auto wakeUpTime = wakeUpTimes.find(faction);
+	if (wakeUpTime != wakeUpTimes.end() && absolute >= wakeUpTime->second) {
+		wakeUpTimes.erase(wakeUpTime);
+		dirtyFactions.insert(faction);
+	}
 
-	std::map<int, int> assignedTasks;
-	CalcAssignedTasks(allTasks, assignedTasks);
+	bool allTasksDirty = dirtyFactions.erase(faction) != 0;
+	// events that occur during this pass will be handled by the next one
+	vector<TaskHandle> newTasks;
+	newTasks.swap(dirtyTasks[faction]);
 
-	COGMEASURE_BEGIN("HYDROQ_SCHEDULER");
-	
-	for (auto& task : allTasks) {
-
-		if (!task->IsDelayed() && !task->IsEnded() && !task->IsProcessing() &&
-			(!task->IsReserved() || (task->IsReserved() && (absolute - task->GetReservedTime()) > 10000))
-			&& (task->GetType() == GameTaskType::BRIDGE_BUILD || task->GetType() == GameTaskType::BRIDGE_DESTROY 
-				|| task->GetType() == GameTaskType::ATTRACT)) {
-
-			auto taskLocation = task->GetTaskNode()->GetTransform().localPos;
-
-			// node at position the bridge will stay
-			auto mapNode = map->GetTile((int)taskLocation.x, (int)taskLocation.y);
-
-			// sort nodes by nearest
-			sort(allWorkers.begin(), allWorkers.end(),
-				[&taskLocation](Node*  a, Node* b) -> bool
-			{
-				return a->GetTransform().localPos.distance(taskLocation) < b->GetTransform().localPos.distance(taskLocation);
-			});
-
-			if (task->GetType() == GameTaskType::ATTRACT) {
-				float absCardinality = gameModel->CalcAttractorAbsCardinality(faction, task->GetTaskNode()->GetId());
-				int neededDistance = absCardinality * 4;
-
-				vector<GameMapTile*> nearestNodes;
-				mapNode->FindWalkableNeighbors(neededDistance, nearestNodes);
-
-				if (!nearestNodes.empty()) {
-					vector<Node*> freeWorkers;
-					// calculate number of free workers
-					for (auto& worker : allWorkers) {
-						if (assignedTasks.find(worker->GetId()) == assignedTasks.end()) {
-							// if this worker is close to another attractor, skip him
-							bool skip = false;
-							vector<Node*> attractors;
-							gameModel->GetAttractorsByFaction(faction, attractors);
-
-							for (auto& attr : attractors) {
-								if (attr->GetId() != task->GetTaskNode()->GetId()) {
-									ofVec2f attrLoc = (attr->GetTransform().localPos) + 0.5f;
-									if (attrLoc.distance(worker->GetTransform().localPos) < 5) {
-										skip = true;
-										break;
-									}
-								}
-							}
-							if (!skip) {
-								freeWorkers.push_back(worker);
-							}
-						}
+	if (!allTasksDirty && newTasks.empty()) {
+		return false;
+	}
+
+	job = SchedulingJob();
+	job.phase = SchedulingPhase::COLLECT;
+	job.faction = faction;
+	gameModel->GetGameTasksByFaction(faction, job.allTasks);
+
+	if (allTasksDirty) {
+		job.tasksToSchedule = job.allTasks;
+	}
+	else {
+		for (auto handle : newTasks) {
+			// tasks removed in the meantime are skipped
+			auto& task = gameModel->GetGameTask(handle);
+			if (task) job.tasksToSchedule.push_back(task);
+		}
+	}
+
+	gameModel->GetMovingObjectsByType(EntityType::WORKER, faction, job.allWorkers);
+	CalcAssignedTasks(job.allTasks, job.assignedTasks);
+	job.candidacies.resize(job.allWorkers.size(), 0);
+	return true;
+}
+
+void TaskScheduler::ProcessJobStep(uint64 absolute) {
+	switch (job.phase) {
+	case SchedulingPhase::COLLECT:
+		if (job.nextItem < job.tasksToSchedule.size()) {
+			CollectTask(absolute);
+		}
+		else {
+			job.phase = SchedulingPhase::SEARCH_PATHS;
+			job.nextItem = 0;
+		}
+		break;
+	case SchedulingPhase::SEARCH_PATHS:
+		if (SearchPaths(job.queries)) {
+			job.phase = SchedulingPhase::ASSIGN;
+		}
+		break;
+	case SchedulingPhase::ASSIGN:
+		AssignBridgeTasks(absolute);
+		job.phase = SchedulingPhase::SEARCH_FALLBACK;
+		job.nextItem = 0;
+		break;
+	case SchedulingPhase::SEARCH_FALLBACK:
+		if (SearchPaths(job.fallbackQueries)) {
+			job.phase = SchedulingPhase::FINISH;
+		}
+		break;
+	case SchedulingPhase::FINISH: {
+		FinishJob(absolute);
+		// the pass has ended; all the collected data are released
+		Faction faction = job.faction;
+		job = SchedulingJob();
+		job.faction = faction;
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+void TaskScheduler::CollectTask(uint64 absolute) {
+	auto task = job.tasksToSchedule[job.nextItem++];
+
+	if (!gameModel->GetGameTask(task->GetHandle())) {
+		// the task has been removed since the pass started
+		return;
+	}
+
+	auto& allWorkers = job.allWorkers;
+	auto& assignedTasks = job.assignedTasks;
+	auto& candidacies = job.candidacies;
+	auto& queries = job.queries;
+	auto faction = job.faction;
+	auto map = gameModel->GetMap();
+
+	if (!task->IsDelayed() && !task->IsEnded() && !task->IsProcessing() &&
+		(!task->IsReserved() || (task->IsReserved() && (absolute - task->GetReservedTime()) > SCHEDULER_RESERVATION_TIMEOUT))
+		&& (task->GetType() == GameTaskType::BRIDGE_BUILD || task->GetType() == GameTaskType::BRIDGE_DESTROY 
+			|| task->GetType() == GameTaskType::ATTRACT)) {
+
+		auto taskLocation = task->GetTaskNode()->GetTransform().localPos;
+
+		// node at position the bridge will stay
+		auto mapNode = map->GetTile((int)taskLocation.x, (int)taskLocation.y);
+
+		if (task->GetType() == GameTaskType::ATTRACT) {
+			float absCardinality = gameModel->CalcAttractorAbsCardinality(faction, task->GetTaskNode()->GetId());
+			int neededDistance = absCardinality * 4;
+
+			vector<GameMapTile*> nearestNodes;
+			mapNode->FindWalkableNeighbors(neededDistance, nearestNodes);
+
+			if (!nearestNodes.empty()) {
+				// sort workers by nearest (bridge tasks refer to workers by their index, so a copy is sorted)
+				vector<Node*> nearestWorkers = allWorkers;
+				sort(nearestWorkers.begin(), nearestWorkers.end(),
+					[&taskLocation](Node*  a, Node* b) -> bool
+				{
+					return a->GetTransform().localPos.distance(taskLocation) < b->GetTransform().localPos.distance(taskLocation);
+				});
+
+				vector<Node*> freeWorkers;
+				// calculate number of free workers
+				for (auto& worker : nearestWorkers) {
+					// if this worker is close to another attractor, skip him
+					if (assignedTasks.find(worker->GetId()) == assignedTasks.end() &&
+						!gameModel->IsNearAttractor(faction, worker->GetTransform().localPos, SCHEDULER_ATTRACTOR_DISTANCE, task->GetTaskNode()->GetId())) {
+						freeWorkers.push_back(worker);
 					}
+				}
 
-					int workersToAssign = allWorkers.size()*absCardinality - task->GetReservedNodes().size();
-					
-					if (workersToAssign != 0) {
-						workersToAssign = max((int)(workersToAssign / 1.8f), 1); // assign continuously :
+				int workersToAssign = allWorkers.size()*absCardinality - task->GetReservedWorkers().size();
+				
+				if (workersToAssign > 0) {
+					// the rest of workers will be assigned during the next passes
+					job.attractorsWaiting = true;
+				}
+
+				if (workersToAssign != 0) {
+					workersToAssign = max((int)(workersToAssign / 1.8f), 1); // assign continuously :
 
-						int workersAvailableToAsign = min(workersToAssign, (int)freeWorkers.size());
+					int workersAvailableToAsign = min(workersToAssign, (int)freeWorkers.size());
 
-						for (int i = 0; i < workersAvailableToAsign; i++) {
-							// prevent from other task to assign
-							assignedTasks[freeWorkers[i]->GetId()]++;
+					for (int i = 0; i < workersAvailableToAsign; i++) {
+						// prevent from other task to assign
+						assignedTasks[freeWorkers[i]->GetId()]++;
 
-							task->GetReservedNodes().push_back(freeWorkers[i]);
-							task->SetIsReserved(true);
-						}
+						gameModel->ReserveGameTask(task, freeWorkers[i]);
 					}
 				}
 			}
-			else {
-				bool workerFound = false;
-				for (auto& worker : allWorkers) {
-
-					// each player's worker can have only up to 4 tasks reserved; 
-					if (assignedTasks.find(worker->GetId()) == assignedTasks.end()) {
-
-						int alreadyAssigned = assignedTasks[worker->GetId()];
-						
-						if (alreadyAssigned <= 4 || (!playerModel->IsMultiplayer() && playerModel->GetFaction() != faction))
-						{
-							// try to find a path
-							float manhattanDistance = abs(worker->GetTransform().localPos.x - taskLocation.x) + abs(worker->GetTransform().localPos.y - taskLocation.y);
-
-							// position the worker stays
-							auto nodeLocation = worker->GetTransform().localPos;
-
-							if (task->GetType() == GameTaskType::BRIDGE_BUILD || task->GetType() == GameTaskType::BRIDGE_DESTROY) {
-								if ((task->GetType() == GameTaskType::BRIDGE_BUILD && mapNode->GetMapTileType() == MapTileType::GROUND) ||
-									task->GetType() == GameTaskType::BRIDGE_DESTROY && mapNode->GetMapTileType() == MapTileType::WATER) {
-									gameModel->RemoveGameTask(task);
-									break;
-								}
-
-								// find nearest node the worker will stay during the building (worker cannot go to the water)
-								auto nodeToBuildfrom = mapNode->FindWalkableNeighbor(Vec2i(taskLocation.x, taskLocation.y));
-
-								if (nodeToBuildfrom != nullptr) {
-									vector<Vec2i> path;
-									map->FindPath(Vec2i(nodeLocation.x, nodeLocation.y), nodeToBuildfrom->GetPosition(), true, path, 2 * manhattanDistance);
-
-									if (!path.empty()) {
-										// assign
-										task->SetIsReserved(true);
-										task->GetReservedNodes().push_back(worker);
-										task->SetReservedTime(absolute);
-										workerFound = true;
-										break;
-									}
-								}
-							}
-						}
+		}
+		else {
+			if ((task->GetType() == GameTaskType::BRIDGE_BUILD && mapNode->GetMapTileType() == MapTileType::GROUND) ||
+				task->GetType() == GameTaskType::BRIDGE_DESTROY && mapNode->GetMapTileType() == MapTileType::WATER) {
+				gameModel->RemoveGameTask(task);
+				return;
+			}
+
+			BridgeTaskQueries taskQueries;
+			taskQueries.task = task;
+			taskQueries.mapNode = mapNode;
+
+			// find nearest node the worker will stay during the building (worker cannot go to the water)
+			auto nodeToBuildfrom = mapNode->FindWalkableNeighbor(Vec2i(taskLocation.x, taskLocation.y));
+
+			if (nodeToBuildfrom != nullptr) {
+				// free workers that haven't been tried by too many tasks yet, by distance
+				vector<pair<float, int>> candidates;
+				for (int i = 0; i < allWorkers.size(); i++) {
+					auto worker = allWorkers[i];
+					if (assignedTasks.find(worker->GetId()) == assignedTasks.end() && candidacies[i] < SCHEDULER_WORKER_CANDIDACIES) {
+						auto nodeLocation = worker->GetTransform().localPos;
+						candidates.push_back(make_pair(abs(nodeLocation.x - taskLocation.x) + abs(nodeLocation.y - taskLocation.y), i));
 					}
 				}
 
+				int candidatesNum = min((int)candidates.size(), SCHEDULER_PATH_CANDIDATES);
+				partial_sort(candidates.begin(), candidates.begin() + candidatesNum, candidates.end());
+
+				for (int i = 0; i < candidatesNum; i++) {
+					int workerIndex = candidates[i].second;
+					candidacies[workerIndex]++;
+
+					// position the worker stays
+					auto nodeLocation = allWorkers[workerIndex]->GetTransform().localPos;
+					float manhattanDistance = candidates[i].first;
+
+					queries.push_back(PathQuery(Vec2i(nodeLocation.x, nodeLocation.y), nodeToBuildfrom->GetPosition(), true, 2 * manhattanDistance));
+					taskQueries.workers.push_back(make_pair(workerIndex, (int)queries.size() - 1));
+				}
+			}
+
+			job.bridgeTasks.push_back(taskQueries);
+		}
+	}
+}
+
+
+bool TaskScheduler::SearchPaths(vector<PathQuery>& queries) {
+	int count = min(SCHEDULER_QUERY_CHUNK, (int)queries.size() - job.nextItem);
+
+	if (count > 0) {
+		vector<PathQuery> chunk(queries.begin() + job.nextItem, queries.begin() + job.nextItem + count);
+		gameModel->GetMap()->FindPaths(chunk);
+
+		for (int i = 0; i < count; i++) {
+			queries[job.nextItem + i].path.swap(chunk[i].path);
+		}
+		job.nextItem += count;
+	}
+
+	return job.nextItem >= queries.size();
+}
+
+void TaskScheduler::AssignBridgeTasks(uint64 absolute) {
+	auto& allWorkers = job.allWorkers;
+	auto& assignedTasks = job.assignedTasks;
+	auto& bridgeTasks = job.bridgeTasks;
+
+	// pairs of tasks and workers that can get there, with the length of the path as the cost
+	vector<AssignmentEdge> edges;
+	for (int i = 0; i < bridgeTasks.size(); i++) {
+		// tasks removed during the pass are skipped
+		if (!gameModel->GetGameTask(bridgeTasks[i].task->GetHandle())) continue;
+
+		for (auto& worker : bridgeTasks[i].workers) {
+			auto& path = job.queries[worker.second].path;
+			// workers reserved by attractors in the meantime are skipped
+			if (!path.empty() && assignedTasks.find(allWorkers[worker.first]->GetId()) == assignedTasks.end()) {
+				edges.push_back(AssignmentEdge(i, worker.first, path.size()));
+			}
+		}
+	}
+
+	// all bridge tasks are assigned at once so that the total distance is minimal
+	vector<int> assignment;
+	AssignmentSolver::Solve(bridgeTasks.size(), allWorkers.size(), edges, assignment);
+
+	for (int i = 0; i < bridgeTasks.size(); i++) {
+		if (assignment[i] != -1) {
+			// assign
+			auto worker = allWorkers[assignment[i]];
+			gameModel->ReserveGameTask(bridgeTasks[i].task, worker);
+			bridgeTasks[i].task->SetReservedTime(absolute);
+			assignedTasks[worker->GetId()]++;
+		}
+	}
+
+	for (int i = 0; i < bridgeTasks.size(); i++) {
+		auto& taskQueries = bridgeTasks[i];
 
-				if (!workerFound) {
-					// no worker assigned -> try to find the complete path
-					for (auto& worker : allWorkers) {
-
-						// each worker can have only up to 2 tasks reserved
-						if (assignedTasks.find(worker->GetId()) == assignedTasks.end() || assignedTasks[worker->GetId()] <= 2) {
-
-							auto nodeLocation = worker->GetTransform().localPos;
-							auto nodeToBuildfrom = mapNode->FindWalkableNeighbor(Vec2i(nodeLocation.x, nodeLocation.y));
-
-							if (nodeToBuildfrom != nullptr) {
-								vector<Vec2i> path;
-								float manhattanDistance = abs(worker->GetTransform().localPos.x - taskLocation.x) 
-									+ abs(worker->GetTransform().localPos.y - taskLocation.y);
-
-								map->FindPath(Vec2i(nodeLocation.x, nodeLocation.y), nodeToBuildfrom->GetPosition(), true, path, 8*manhattanDistance);
-
-								if (!path.empty()) {
-									// assign
-									task->SetIsReserved(true);
-									task->GetReservedNodes().push_back(worker);
-									task->SetReservedTime(absolute);
-									workerFound = true;
-									break;
-								}
-								else {
-									// no path could be found -> set delay property
-									task->SetIsDelayed(true);
-									break;
-								}
-							}
-						}
+		if (assignment[i] == -1 && gameModel->GetGameTask(taskQueries.task->GetHandle())) {
+			auto taskLocation = taskQueries.task->GetTaskNode()->GetTransform().localPos;
+
+			// no worker assigned -> the nearest worker that doesn't have too many tasks will try to find the complete path
+			Node* fallbackWorker = nullptr;
+			float fallbackDistance = 0;
+
+			for (auto& worker : allWorkers) {
+				// each worker can have only up to 2 tasks reserved
+				if (assignedTasks.find(worker->GetId()) == assignedTasks.end() || assignedTasks[worker->GetId()] <= 2) {
+					float distance = worker->GetTransform().localPos.distance(taskLocation);
+					if (fallbackWorker == nullptr || distance < fallbackDistance) {
+						fallbackWorker = worker;
+						fallbackDistance = distance;
 					}
 				}
+			}
 
+			if (fallbackWorker != nullptr) {
+				auto nodeLocation = fallbackWorker->GetTransform().localPos;
+				auto fallbackNode = taskQueries.mapNode->FindWalkableNeighbor(Vec2i(nodeLocation.x, nodeLocation.y));
 
+				if (fallbackNode != nullptr) {
+					float manhattanDistance = abs(nodeLocation.x - taskLocation.x) + abs(nodeLocation.y - taskLocation.y);
+					taskQueries.fallbackWorker = fallbackWorker;
+					job.fallbackQueries.push_back(PathQuery(Vec2i(nodeLocation.x, nodeLocation.y), fallbackNode->GetPosition(), true, 8 * manhattanDistance));
+					job.fallbackTasks.push_back(i);
+				}
 			}
 		}
 	}
+}
 
-	COGMEASURE_END("HYDROQ_SCHEDULER");
-}
\ No newline at end of file
+void TaskScheduler::FinishJob(uint64 absolute) {
+	for (int i = 0; i < job.fallbackTasks.size(); i++) {
+		auto& taskQueries = job.bridgeTasks[job.fallbackTasks[i]];
+		auto task = taskQueries.task;
+
+		if (!gameModel->GetGameTask(task->GetHandle())) {
+			// the task has been removed during the pass
+			continue;
+		}
+
+		if (!job.fallbackQueries[i].path.empty()) {
+			// assign
+			gameModel->ReserveGameTask(task, taskQueries.fallbackWorker);
+			task->SetReservedTime(absolute);
+		}
+		else {
+			// no path could be found -> set delay property
+			task->SetIsDelayed(true);
+		}
+	}
+
+	// tasks that can't be assigned now wait for an event, except expiring reservations and attractors
+	uint64 nextWakeUp = job.attractorsWaiting ? absolute + SCHEDULER_ATTRACT_INTERVAL : 0;
+
+	for (auto& task : job.allTasks) {
+		if (task->IsReserved() && !task->IsEnded() && !task->IsProcessing() && task->GetType() != GameTaskType::ATTRACT) {
+			uint64 expiration = task->GetReservedTime() + SCHEDULER_RESERVATION_TIMEOUT + 1;
+			if (nextWakeUp == 0 || expiration < nextWakeUp) {
+				nextWakeUp = expiration;
+			}
+		}
+	}
+
+	if (nextWakeUp != 0) {
+		wakeUpTimes[job.faction] = nextWakeUp;
+	}
+	else {
+		wakeUpTimes.erase(job.faction);
+	}
+}
@@ -3,36 +3,122 @@
 #include "HydroqDef.h"
 #include "State.h"
 #include "StrId.h"
-#include "GameGoals.h"
 #include "GameTask.h"
 #include "GameMap.h"
 #include "GameModel.h"
 #include "PlayerModel.h"
 #include "ComponentStorage.h"
+#include "AssignmentSolver.h"
+
+// number of nearest workers whose paths are searched for each bridge task
+#define SCHEDULER_PATH_CANDIDATES 4
+// maximal number of bridge tasks a worker can be a candidate for during one pass
+#define SCHEDULER_WORKER_CANDIDACIES 4
+// time after which a reserved task that hasn't been started is scheduled again [ms]
+#define SCHEDULER_RESERVATION_TIMEOUT 10000
+// interval of scheduling of attractors that still need more workers [ms]
+#define SCHEDULER_ATTRACT_INTERVAL 1000
+// distance from another attractor at which workers aren't assigned to an attractor
+#define SCHEDULER_ATTRACTOR_DISTANCE 5
+// time the scheduler may spend in one frame, if not set in the configuration [us]
+#define SCHEDULER_DEFAULT_BUDGET 1000
+// number of path queries searched in one step of a pass
+#define SCHEDULER_QUERY_CHUNK 8
+
+/**
+* Phase of a scheduling pass
+*/
+enum class SchedulingPhase {
+	IDLE,				/** no pass is running */
+	COLLECT,			/** tasks are examined one by one, attractors get their workers */
+	SEARCH_PATHS,		/** paths of the nearest workers to bridge tasks are searched */
+	ASSIGN,				/** bridge tasks are matched with workers */
+	SEARCH_FALLBACK,	/** paths of fallback workers of the remaining bridge tasks are searched */
+	FINISH				/** results of fallback workers are applied */
+};
 
 /**
 * Scheduler that searches in a set of not assigned tasks and tries to
-* assign them to available workers
+* assign them to available workers; tasks are scheduled only when an event
+* that may affect them occurs (a new task, a free worker or a new platform)
+* A pass is processed in small steps under a time budget per frame and continues
+* where it left off in the next frame
 */
 class TaskScheduler : public Behavior {
 
 private:
+
+	/**
+	* Bridge task waiting for the results of path queries
+	*/
+	struct BridgeTaskQueries {
+		// scheduled task
+		spt<GameTask> task;
+		// tile the bridge will stay at
+		GameMapTile* mapNode = nullptr;
+		// indices of the nearest workers with indices of their queries
+		vector<pair<int, int>> workers;
+		// worker that is tried if none of the nearest workers can be assigned to the task
+		Node* fallbackWorker = nullptr;
+	};
+
+	/**
+	* State of a scheduling pass that may be spread over several frames
+	*/
+	struct SchedulingJob {
+		// actual phase
+		SchedulingPhase phase = SchedulingPhase::IDLE;
+		// scheduled faction
+		Faction faction = Faction::NONE;
+		// all tasks of the faction
+		vector<spt<GameTask>> allTasks;
+		// tasks that should be scheduled
+		vector<spt<GameTask>> tasksToSchedule;
+		// workers of the faction
+		vector<Node*> allWorkers;
+		// number of tasks reserved for each worker (see CalcAssignedTasks)
+		map<int, int> assignedTasks;
+		// number of bridge tasks each worker is a candidate for
+		vector<int> candidacies;
+		// path queries of the nearest workers
+		vector<PathQuery> queries;
+		// bridge tasks waiting for the results of path queries
+		vector<BridgeTaskQueries> bridgeTasks;
+		// path queries of fallback workers
+		vector<PathQuery> fallbackQueries;
+		// indices of bridge tasks of the fallback queries
+		vector<int> fallbackTasks;
+		// index of the next task or query to process in the actual phase
+		int nextItem = 0;
+		// indicator whether there are attractors that still need more workers
+		bool attractorsWaiting = false;
+	};
+
 	GameModel* gameModel;
 	PlayerModel* playerModel;
+	// new tasks that should be scheduled during the next pass, for each faction
+	map<Faction, vector<TaskHandle>> dirtyTasks;
+	// factions whose tasks should all be scheduled during the next pass
+	set<Faction> dirtyFactions;
+	// time the tasks of each faction should be scheduled again even if nothing happens
+	// (expiring reservations, attractors that need more workers)
+	map<Faction, uint64> wakeUpTimes;
+	// the running pass
+	SchedulingJob job;
+	// time the scheduler may spend in one frame [us]
+	int budget = SCHEDULER_DEFAULT_BUDGET;
 public:
 
 	TaskScheduler(GameModel* gameModel) :gameModel(gameModel) {
 
 	}
 
-	void OnInit() {
-		playerModel = GETCOMPONENT(PlayerModel);
-	}
+	void OnInit();
+
+	void OnMessage(Msg& msg);
 
 	virtual void Update(const uint64 delta, const uint64 absolute) {
-		if (CogGetFrameCounter() % 60 == 0) {
-			ScheduleTasks(absolute);
-		}
+		ScheduleTasks(absolute);
 	}
 
 
@@ -45,13 +131,48 @@ protected:
 	void CalcAssignedTasks(vector<spt<GameTask>>& tasks, map<int, int>& output);
 
 	/**
-	* Schedules tasks for all workers
+	* Schedules tasks for all workers until the budget of the frame is spent
 	*/
 	void ScheduleTasks(uint64 absolute);
 
 	/**
-	* Schedules tasks for selected faction (only for games against AI)
+	* Starts a new pass for the next faction with tasks that might be affected by recent events
+	* @return true, if a pass has been started
+	*/
+	bool StartJob(uint64 absolute);
+
+	/**
+	* Starts a new pass for selected faction, if there are any tasks that might be affected by recent events
+	* @return true, if a pass has been started
+	*/
+	bool StartJob(uint64 absolute, Faction faction);
+
+	/**
+	* Processes one step of the running pass
+	*/
+	void ProcessJobStep(uint64 absolute);
+
+	/**
+	* Examines the next task of the running pass; attractors get their workers at once,
+	* bridge tasks get path queries for their nearest workers
+	*/
+	void CollectTask(uint64 absolute);
+
+	/**
+	* Searches the next chunk of path queries
+	* @return true, if all queries have been searched
+	*/
+	bool SearchPaths(vector<PathQuery>& queries);
+
+	/**
+	* Matches bridge tasks with workers that can get there and
+	* prepares queries of fallback workers for the remaining ones
+	*/
+	void AssignBridgeTasks(uint64 absolute);
+
+	/**
+	* Applies results of fallback workers and plans the next pass
 	*/
-	void ScheduleTasksForFaction(uint64 absolute, Faction faction);
+	void FinishJob(uint64 absolute);
 
 };
\ No newline at end of file
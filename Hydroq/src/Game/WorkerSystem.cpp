@@ -0,0 +1,597 @@
+#include "WorkerSystem.h"
+#include "GameModel.h"
+#include "NodeCellObject.h"
+
+void WorkerSystem::Init(GameModel* gameModel) {
+	this->gameModel = gameModel;
+
+	auto& settings = CogGetProjectSettings();
+	steeringParams.maxSpeed = WORKER_MAX_SPEED;
+	steeringParams.maxAcceleration = settings.GetSettingValFloat("hydroq_set", "unit_max_acc");
+	steeringParams.maxRadialAcceleration = settings.GetSettingValFloat("hydroq_set", "unit_max_radial_acc");
+	steeringParams.arriveRadius = WORKER_ARRIVE_RADIUS;
+	buildingDelay = settings.GetSettingValInt("hydroq_set", "building_delay");
+	destroyDelay = settings.GetSettingValInt("hydroq_set", "destroy_delay");
+
+	mapWidth = gameModel->GetMap()->GetWidth();
+	mapHeight = gameModel->GetMap()->GetHeight();
+}
+
+void WorkerSystem::AddWorker(Node* node, Faction faction) {
+	indices[node->GetId()] = nodes.size();
+	nodes.push_back(node);
+	steering.Add(node->GetTransform().localPos.x, node->GetTransform().localPos.y);
+	rotations.push_back(node->GetTransform().rotation);
+	factions.push_back(faction);
+	states.push_back(WorkerState::IDLE);
+	paths.push_back(WorkerPath());
+	jobs.push_back(WorkerJob());
+	keepHeadings.push_back(false);
+
+	node->SetState(GetStateName(WorkerState::IDLE));
+}
+
+void WorkerSystem::SetFaction(Node* node, Faction faction) {
+	auto found = indices.find(node->GetId());
+	if (found != indices.end()) {
+		factions[found->second] = faction;
+	}
+}
+
+void WorkerSystem::Update(const uint64 delta, const uint64 absolute) {
+	UpdateIdleWorkers(absolute);
+	UpdateBuildingWorkers(absolute);
+	UpdateAttractedWorkers(absolute);
+	SeparateWorkers();
+	IntegrateMovement(min(delta / 1000.0f, WORKER_MAX_TIME_STEP));
+	SyncNodes();
+}
+
+void WorkerSystem::UpdateIdleWorkers(uint64 absolute) {
+	int frame = CogGetFrameCounter();
+
+	for (int i = 0; i < nodes.size(); i++) {
+		if (states[i] != WorkerState::IDLE) continue;
+
+		// each nth frame find a task to do; workers are spread over the frames
+		if ((frame + i) % WORKER_TASK_CHECK_INTERVAL == 0 && FindTaskToDo(i)) {
+			continue;
+		}
+
+		if (paths[i].IsFinished()) {
+			WanderAround(i);
+		}
+	}
+}
+
+void WorkerSystem::UpdateBuildingWorkers(uint64 absolute) {
+	for (int i = 0; i < nodes.size(); i++) {
+		if (states[i] != WorkerState::BUILD) continue;
+
+		auto& job = jobs[i];
+
+		if (IsTaskRemoved(i)) {
+			COGLOGDEBUG("Hydroq", "Building task aborted");
+			AbortTask(i);
+			continue;
+		}
+
+		if (!paths[i].IsFinished()) {
+			// recalculate only if the map change has blocked the actual path
+			if (job.task->NeedRecalculation() && IsPathBlocked(i) && !RecalcPath(i)) {
+				AbortTask(i);
+			}
+			continue;
+		}
+
+		if (job.workStarted == 0) {
+			job.workStarted = absolute;
+			continue;
+		}
+
+		auto position = Vec2i(job.task->GetTaskNode()->GetTransform().localPos);
+
+		if (job.task->GetType() == GameTaskType::BRIDGE_BUILD) {
+			// building lasts xxx ms
+			if ((absolute - job.workStarted) <= buildingDelay) continue;
+
+			CogLogDebug("Hydroq", "Building bridge");
+			gameModel->BuildPlatform(position);
+		}
+		else {
+			if ((absolute - job.workStarted) <= destroyDelay || (CogGetFrameCounter() + i) % 10 != 0) continue;
+
+			// check if nobody is inside the area that will be destroyed
+			vector<NodeCellObject*> neighbours;
+			gameModel->GetCellSpace()->CalcNeighbors(ofVec2f(position.x + 0.5f, position.y + 0.5f), 0.5f, neighbours);
+			if (!neighbours.empty() && !(neighbours.size() == 1 && neighbours[0]->node->GetId() == nodes[i]->GetId())) continue;
+
+			CogLogDebug("Hydroq", "Destroying bridge");
+			gameModel->DestroyPlatform(position);
+		}
+
+		auto task = job.task;
+		task->SetIsEnded(true);
+		job = WorkerJob();
+		ChangeState(i, WorkerState::IDLE);
+		gameModel->RemoveGameTask(task);
+	}
+}
+
+void WorkerSystem::UpdateAttractedWorkers(uint64 absolute) {
+	for (int i = 0; i < nodes.size(); i++) {
+		if (states[i] != WorkerState::ATTRACT) continue;
+
+		auto& job = jobs[i];
+
+		if (IsTaskRemoved(i)) {
+			COGLOGDEBUG("Hydroq", "Attractor task aborted");
+			AbortTask(i);
+		}
+		else if (!paths[i].IsFinished()) {
+			if (job.task->NeedRecalculation() && IsPathBlocked(i) && !RecalcPath(i)) {
+				AbortTask(i);
+			}
+		}
+		else {
+			// attractor reached, the worker is free again
+			auto task = job.task;
+			job = WorkerJob();
+			ChangeState(i, WorkerState::IDLE);
+			gameModel->CancelGameTaskReservation(task, nodes[i]->GetId());
+		}
+	}
+}
+
+void WorkerSystem::SeparateWorkers() {
+	auto map = gameModel->GetMap();
+	FillBuckets();
+
+	for (int i = 0; i < nodes.size(); i++) {
+		ofVec2f position = GetPosition(i);
+		ofVec2f force = ofVec2f(0, 0);
+		int pushingNeighbours = 0;
+
+		// the radius is smaller than a tile, hence at most 2x2 buckets are searched
+		int minX = max((int)floorf(position.x - WORKER_SEPARATION_RADIUS), 0);
+		int maxX = min((int)floorf(position.x + WORKER_SEPARATION_RADIUS), mapWidth - 1);
+		int minY = max((int)floorf(position.y - WORKER_SEPARATION_RADIUS), 0);
+		int maxY = min((int)floorf(position.y + WORKER_SEPARATION_RADIUS), mapHeight - 1);
+
+		for (int y = minY; y <= maxY && pushingNeighbours < WORKER_SEPARATION_NEIGHBORS; y++) {
+			for (int x = minX; x <= maxX && pushingNeighbours < WORKER_SEPARATION_NEIGHBORS; x++) {
+				auto found = tileBuckets.find(y*mapWidth + x);
+				if (found == tileBuckets.end()) continue;
+				int bucket = found->second;
+
+				for (int k = 0; k < bucketSizes[bucket] && pushingNeighbours < WORKER_SEPARATION_NEIGHBORS; k++) {
+					int neighbour = buckets[bucket*WORKER_SEPARATION_NEIGHBORS + k];
+					if (neighbour == i) continue;
+
+					ofVec2f away = position - GetPosition(neighbour);
+					float distance = away.length();
+					if (distance >= WORKER_SEPARATION_RADIUS) continue;
+
+					// workers at the same position are pushed apart by the order of their indices
+					ofVec2f direction = distance > STEERING_EPSILON ? away / distance : ofVec2f(i < neighbour ? -1.0f : 1.0f, 0);
+					force += direction * (WORKER_SEPARATION_FORCE * (1.0f - distance / WORKER_SEPARATION_RADIUS));
+					pushingNeighbours++;
+				}
+			}
+		}
+
+		// never push a worker into the water; each axis is checked separately so that the worker can slide along the shore
+		if (force.x != 0 && !map->IsPassable((int)floorf(position.x + (force.x > 0 ? WORKER_SEPARATION_RADIUS : -WORKER_SEPARATION_RADIUS)),
+			(int)floorf(position.y), true)) {
+			force.x = 0;
+		}
+
+		if (force.y != 0 && !map->IsPassable((int)floorf(position.x),
+			(int)floorf(position.y + (force.y > 0 ? WORKER_SEPARATION_RADIUS : -WORKER_SEPARATION_RADIUS)), true)) {
+			force.y = 0;
+		}
+
+		steering.separationsX[i] = force.x;
+		steering.separationsY[i] = force.y;
+	}
+}
+
+void WorkerSystem::FillBuckets() {
+	// the collections keep their capacity, there are never more buckets than workers
+	tileBuckets.clear();
+	bucketSizes.clear();
+
+	for (int i = 0; i < nodes.size(); i++) {
+		int x = (int)floorf(steering.positionsX[i]);
+		int y = (int)floorf(steering.positionsY[i]);
+		if (x < 0 || y < 0 || x >= mapWidth || y >= mapHeight) continue;
+
+		auto inserted = tileBuckets.insert(make_pair(y*mapWidth + x, (int)bucketSizes.size()));
+		int bucket = inserted.first->second;
+
+		if (inserted.second) {
+			// first worker at the tile
+			bucketSizes.push_back(0);
+			if (buckets.size() < bucketSizes.size()*WORKER_SEPARATION_NEIGHBORS) {
+				buckets.resize(bucketSizes.size()*WORKER_SEPARATION_NEIGHBORS);
+			}
+		}
+
+		// workers over the capacity are still pushed by the others, they just don't push anyone
+		int& size = bucketSizes[bucket];
+		if (size == WORKER_SEPARATION_NEIGHBORS) continue;
+		buckets[bucket*WORKER_SEPARATION_NEIGHBORS + size++] = i;
+	}
+}
+
+void WorkerSystem::IntegrateMovement(float deltaTime) {
+	// move to the next point of the path if the actual one has been reached
+	for (int i = 0; i < nodes.size(); i++) {
+		auto& path = paths[i];
+		if (path.IsFinished()) continue;
+
+		bool isLastPoint = path.nextPoint == path.points.size() - 1;
+		float distance = path.points[path.nextPoint].distance(GetPosition(i));
+		float tolerance = isLastPoint ? WORKER_FINAL_TOLERANCE : WORKER_POINT_TOLERANCE;
+
+		if (isLastPoint && (steering.separationsX[i] != 0 || steering.separationsY[i] != 0)) {
+			// the end of the path is crowded, it can't be reached precisely
+			tolerance = WORKER_SEPARATION_RADIUS;
+		}
+
+		if (distance < tolerance) {
+			if (isLastPoint) {
+				Stop(i);
+				continue;
+			}
+			path.nextPoint++;
+			SetTarget(i);
+		}
+	}
+
+	SteeringKernel::Integrate(steering, steeringParams, deltaTime);
+}
+
+void WorkerSystem::SetTarget(int index) {
+	auto& path = paths[index];
+	auto& point = path.points[path.nextPoint];
+	steering.targetsX[index] = point.x;
+	steering.targetsY[index] = point.y;
+	steering.speeds[index] = WORKER_MAX_SPEED;
+	// slow down only at the end of the path
+	steering.arrivals[index] = path.nextPoint == path.points.size() - 1 ? 1.0f : 0.0f;
+}
+
+void WorkerSystem::SyncNodes() {
+	for (int i = 0; i < nodes.size(); i++) {
+		float velocityX = steering.velocitiesX[i];
+		float velocityY = steering.velocitiesY[i];
+
+		if (velocityX != 0 || velocityY != 0) {
+			// 0 degrees is heading up, clockwise
+			rotations[i] = ofRadToDeg(atan2(velocityY, velocityX)) + 90;
+		}
+
+		auto& transform = nodes[i]->GetTransform();
+		transform.localPos.x = steering.positionsX[i];
+		transform.localPos.y = steering.positionsY[i];
+		transform.rotation = rotations[i];
+	}
+}
+
+bool WorkerSystem::FindTaskToDo(int index) {
+	// position the worker stays
+	auto start = GetPosition(index);
+
+	// only tasks reserved for this worker are taken into account; there are just a few of them
+	auto& reservedTasks = gameModel->GetReservedGameTasks(nodes[index]->GetId());
+	if (reservedTasks.empty()) return false;
+
+	// order reserved tasks by distance
+	vector<pair<float, int>> taskOrder;
+	for (int i = 0; i < reservedTasks.size(); i++) {
+		auto& task = gameModel->GetGameTask(reservedTasks[i]);
+		taskOrder.push_back(make_pair(task->GetTaskNode()->GetTransform().localPos.distanceSquared(start), i));
+	}
+	sort(taskOrder.begin(), taskOrder.end());
+
+	auto map = gameModel->GetMap();
+
+	// get the nearest task
+	for (auto& order : taskOrder) {
+		auto task = gameModel->GetGameTask(reservedTasks[order.second]);
+		if (!task->IsReserved()) continue;
+
+		// position of the place the bridge will stay
+		auto position = task->GetTaskNode()->GetTransform().localPos;
+		// node at position the bridge will stay
+		auto mapTile = map->GetTile((int)position.x, (int)position.y);
+
+		if (task->GetType() == GameTaskType::BRIDGE_BUILD || task->GetType() == GameTaskType::BRIDGE_DESTROY) {
+
+			GameMapTile* tileToWorkFrom;
+
+			if (task->GetType() == GameTaskType::BRIDGE_BUILD) {
+				// find first safe platform the worker can stay on
+				tileToWorkFrom = mapTile->FindWalkableNeighbor(Vec2i(start.x, start.y));
+			}
+			else {
+				// find platform the worker can return to base from
+				auto nearestBase = gameModel->FindNearestRigByFaction(factions[index], start);
+				ofVec2f preferredPosition = (nearestBase != nullptr) ? nearestBase->GetTransform().localPos : start;
+				tileToWorkFrom = mapTile->FindWalkableNeighbor(Vec2i(preferredPosition.x, preferredPosition.y));
+				if (tileToWorkFrom == nullptr) tileToWorkFrom = mapTile->FindNeighborByType(MapTileType::RIG_PLATFORM, Vec2i(preferredPosition.x, preferredPosition.y));
+			}
+
+			if (tileToWorkFrom != nullptr) {
+				COGLOGDEBUG("Hydroq", "Got task for bridge building at position [%d,%d]", (int)position.x, (int)position.y);
+				StartBuilding(index, task, tileToWorkFrom);
+				return true;
+			}
+		}
+		else if (task->GetType() == GameTaskType::ATTRACT) {
+			float cardinality = gameModel->CalcAttractorAbsCardinality(factions[index], task->GetTaskNode()->GetId());
+			int neededDistance = cardinality * 4;
+			vector<GameMapTile*> nearestNodes;
+			mapTile->FindWalkableNeighbors(neededDistance, nearestNodes);
+
+			if (!nearestNodes.empty()) {
+				auto randomNodeToFollow = nearestNodes[ofRandom(0, 1)*nearestNodes.size()];
+				COGLOGDEBUG("Hydroq", "Got task for attractor following at position [%d,%d]", randomNodeToFollow->GetPosition().x, randomNodeToFollow->GetPosition().y);
+				StartAttracting(index, task, randomNodeToFollow, neededDistance);
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void WorkerSystem::WanderAround(int index) {
+	// find some point that can be used
+	float x = 0;
+	float y = 0;
+
+	if (ofRandom(0, 1) > 0.5f) {
+		// try to go up or down
+		y = ofRandom(-2.0f, 2.0f);
+	}
+	else {
+		// try to go left or right
+		x = ofRandom(-2.0f, 2.0f);
+	}
+
+	if (keepHeadings[index]) {
+		// keep heading if task has just been finished
+		int heading = ((int)rotations[index]) % 360;
+
+		if (heading < 0) heading = 360 + heading;
+
+		if (heading > 250 || heading <= 0) {
+			x = -0.7f; y = 0;
+		}
+		else if (heading > 0 && heading <= 80) {
+			x = 0; y = -0.7f;
+		}
+		else if (heading > 80 && heading < 170) {
+			x = 0.7f; y = 0;
+		}
+		else {
+			x = 0; y = 0.7f;
+		}
+		keepHeadings[index] = false;
+	}
+
+	auto startPrec = GetPosition(index);
+	auto start = Vec2i(startPrec);
+	auto endPrec = startPrec + ofVec2f(x, y);
+	auto end = Vec2i(endPrec);
+
+	// check if we can go at selected location
+	vector<Vec2i> map;
+	gameModel->GetMap()->FindPath(start, end, false, map, 5);
+
+	if (map.size() > 0 && map.size() <= 2) {
+		// go there
+		auto& path = paths[index];
+		path.points.clear();
+		path.points.push_back(endPrec);
+		path.nextPoint = 0;
+		SetTarget(index);
+	}
+}
+
+void WorkerSystem::StartBuilding(int index, spt<GameTask> task, GameMapTile* tileToBuildFrom) {
+	Stop(index);
+	ChangeState(index, WorkerState::BUILD);
+	keepHeadings[index] = true;
+
+	task->SetHandlerNode(nodes[index]);
+	task->SetIsProcessing(true);
+
+	// position where the bridge will stay
+	auto position = task->GetTaskNode()->GetTransform().localPos;
+	// safe position the worker can stay during the building
+	auto targetSafePos = tileToBuildFrom->GetPosition();
+
+	auto& job = jobs[index];
+	job = WorkerJob();
+	job.task = task;
+	// precise position will be little bit close to the edge of the existing platform
+	job.targetPosition = ofVec2f(targetSafePos.x + (position.x - targetSafePos.x) / 2.0f + 0.5f,
+		targetSafePos.y + (position.y - targetSafePos.y) / 2.0f + 0.5f);
+	// all workers working from the same tile share the planner
+	job.planner = gameModel->GetMap()->GetPathPlanner(Vec2i(GetPosition(index)), targetSafePos, true);
+
+	if (!RecalcPath(index)) {
+		COGLOGDEBUG("Hydroq", "Couldn't find path to the bridge");
+		AbortTask(index);
+	}
+}
+
+void WorkerSystem::StartAttracting(int index, spt<GameTask> task, GameMapTile* tileToFollow, int attractorRadius) {
+	Stop(index);
+	ChangeState(index, WorkerState::ATTRACT);
+
+	auto map = gameModel->GetMap();
+	auto position = tileToFollow->GetPosition();
+
+	auto& job = jobs[index];
+	job = WorkerJob();
+	job.task = task;
+	// the followed tile is walkable, hence its center is the fallback
+	job.targetPosition = ofVec2f(position.x + 0.5f, position.y + 0.5f);
+
+	for (int i = 0; i < WORKER_SCATTER_ATTEMPTS; i++) {
+		ofVec2f randomPosition = ofVec2f(position.x + ofRandom(-1, 1), position.y + ofRandom(-1, 1));
+		if (map->IsPassable((int)floorf(randomPosition.x), (int)floorf(randomPosition.y), true)) {
+			job.targetPosition = randomPosition;
+			break;
+		}
+	}
+
+	// all workers going to the attractor share its flow field
+	job.flowField = map->GetFlowField(Vec2i(task->GetTaskNode()->GetTransform().localPos));
+	job.attractorRadius = attractorRadius;
+
+	if (!RecalcPath(index)) {
+		COGLOGDEBUG("Hydroq", "Couldn't find path to the attractor");
+		AbortTask(index);
+	}
+}
+
+bool WorkerSystem::RecalcPath(int index) {
+	auto& job = jobs[index];
+	auto startCell = Vec2i(GetPosition(index));
+
+	// find path; only the part of the search affected by map changes is recalculated
+	vector<Vec2i> map;
+	if (job.flowField) {
+		FindAttractorPath(index, startCell, map);
+	}
+	else {
+		job.planner->SetStart(startCell);
+		job.planner->CalcPath(map);
+	}
+	job.pathCells = map;
+
+	if (map.empty()) {
+		return false;
+	}
+
+	auto& path = paths[index];
+	path.points.clear();
+	path.nextPoint = 0;
+	path.points.push_back(map.size() >= 2 ? ofVec2f(map[1].x, map[1].y) + 0.5f : job.targetPosition);
+
+	for (int i = 2; i < map.size(); i++) {
+		// always keep at the center
+		path.points.push_back(ofVec2f(map[i].x + 0.5f, map[i].y + 0.5f));
+	}
+
+	if (map.size() >= 2) {
+		// add the last segment
+		path.points.push_back(job.targetPosition);
+	}
+
+	SetTarget(index);
+	return true;
+}
+
+bool WorkerSystem::FindAttractorPath(int index, Vec2i start, vector<Vec2i>& output) {
+	auto& job = jobs[index];
+	auto map = gameModel->GetMap();
+	Vec2i attractor = job.flowField->GetTarget();
+	Vec2i end = Vec2i((int)floorf(job.targetPosition.x), (int)floorf(job.targetPosition.y));
+
+	// the target lies at most one tile off the area the followed tile has been picked from
+	int radius = job.attractorRadius + 1;
+	auto isInArea = [&](Vec2i cell) {
+		return abs(cell.x - attractor.x) <= radius && abs(cell.y - attractor.y) <= radius;
+	};
+
+	// the search needn't expand more tiles than the area has
+	int maxIteration = (2 * radius + 1)*(2 * radius + 1);
+
+	if (!isInArea(start)) {
+		vector<Vec2i> fieldPath;
+		if (job.flowField->CalcPath(start, fieldPath)) {
+			// follow the field to the edge of the area
+			for (auto& cell : fieldPath) {
+				output.push_back(cell);
+				if (isInArea(cell)) break;
+			}
+			start = output.back();
+			output.pop_back();
+		}
+		else {
+			// the attractor itself can't be reached, the target may still be
+			maxIteration = 0;
+		}
+	}
+
+	int fieldSteps = output.size();
+	map->FindPath(start, end, true, output, maxIteration);
+
+	if ((int)output.size() == fieldSteps) {
+		if (fieldSteps == 0) return false;
+
+		// the target can't be reached from the area -> stay at its edge
+		output.push_back(start);
+		job.targetPosition = ofVec2f(start.x + 0.5f, start.y + 0.5f);
+	}
+
+	return true;
+}
+
+bool WorkerSystem::IsPathBlocked(int index) {
+	auto& job = jobs[index];
+	auto map = gameModel->GetMap();
+	for (auto& cell : job.pathCells) {
+		if (!map->IsPassable(map->GetTileIndex(cell), true)) return true;
+	}
+	return false;
+}
+
+void WorkerSystem::AbortTask(int index) {
+	auto task = jobs[index].task;
+	jobs[index] = WorkerJob();
+	Stop(index);
+	ChangeState(index, WorkerState::IDLE);
+
+	task->SetIsProcessing(false);
+	task->SetIsReserved(false);
+	gameModel->CancelGameTaskReservation(task, nodes[index]->GetId());
+}
+
+void WorkerSystem::ChangeState(int index, WorkerState state) {
+	nodes[index]->ResetState(GetStateName(states[index]));
+	nodes[index]->SetState(GetStateName(state));
+	states[index] = state;
+}
+
+void WorkerSystem::Stop(int index) {
+	paths[index].points.clear();
+	paths[index].nextPoint = 0;
+	steering.velocitiesX[index] = 0;
+	steering.velocitiesY[index] = 0;
+	steering.targetsX[index] = steering.positionsX[index];
+	steering.targetsY[index] = steering.positionsY[index];
+	steering.speeds[index] = 0;
+}
+
+bool WorkerSystem::IsTaskRemoved(int index) {
+	auto& task = jobs[index].task;
+	return task->IsEnded() || !gameModel->GetGameTask(task->GetHandle());
+}
+
+StrId WorkerSystem::GetStateName(WorkerState state) const {
+	switch (state) {
+	case WorkerState::BUILD:
+		return StrId(STATE_WORKER_BUILD);
+	case WorkerState::ATTRACT:
+		return StrId(STATE_WORKER_ATTRACTOR_FOLLOW);
+	default:
+		return StrId(STATE_WORKER_IDLE);
+	}
+}
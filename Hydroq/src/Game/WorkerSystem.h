@@ -0,0 +1,272 @@
+#pragma once
+
+#include "HydroqDef.h"
+#include "GameTask.h"
+#include "GameMap.h"
+#include "IncrementalPathPlanner.h"
+#include "FlowField.h"
+#include "SteeringKernel.h"
+#include <unordered_map>
+
+using namespace Cog;
+
+class GameModel;
+
+// maximal speed of a worker [tiles/s]
+#define WORKER_MAX_SPEED 2.0f
+// distance from the last point of a path at which the worker starts to slow down [tiles]
+#define WORKER_ARRIVE_RADIUS 0.5f
+// distance at which a point of a path is considered as passed [tiles]
+#define WORKER_POINT_TOLERANCE 0.25f
+// distance at which the last point of a path is considered as reached [tiles]
+#define WORKER_FINAL_TOLERANCE 0.1f
+// maximal time step of the movement integration [s]
+#define WORKER_MAX_TIME_STEP 0.1f
+// number of frames after which an idle worker checks its reserved tasks
+#define WORKER_TASK_CHECK_INTERVAL 30
+// distance below which workers push each other away [tiles]
+#define WORKER_SEPARATION_RADIUS 0.35f
+// force that pushes apart two workers at the same position [tiles/s^2]
+#define WORKER_SEPARATION_FORCE 8.0f
+// number of attempts to pick a random position near the followed tile that isn't in the water
+#define WORKER_SCATTER_ATTEMPTS 5
+// maximal number of neighbours that push a worker away, as well as the capacity of the bucket of one tile
+#define WORKER_SEPARATION_NEIGHBORS 6
+
+/**
+* State of a worker
+*/
+enum class WorkerState {
+	IDLE,		/** wandering around, waiting for a task */
+	BUILD,		/** going to build or destroy a bridge */
+	ATTRACT		/** following an attractor */
+};
+
+/**
+* Path a worker follows
+*/
+struct WorkerPath {
+	// points of the path
+	vector<ofVec2f> points;
+	// index of the point the worker heads to; the path is finished if it equals the number of points
+	int nextPoint = 0;
+
+	/**
+	* Returns true, if the worker has reached the last point of the path
+	*/
+	bool IsFinished() const {
+		return nextPoint >= points.size();
+	}
+};
+
+/**
+* Task a worker is processing
+*/
+struct WorkerJob {
+	// processed task
+	spt<GameTask> task;
+	// planner that repairs the path when the map changes, shared with other workers heading to the same tile
+	spt<IncrementalPathPlanner> planner;
+	// flow field of the attractor, shared with other workers following it (if used)
+	spt<FlowField> flowField;
+	// radius of the area around the attractor the worker scatters in [tiles]
+	int attractorRadius = 0;
+	// cells of the actual path
+	vector<Vec2i> pathCells;
+	// precise position the worker goes to
+	ofVec2f targetPosition;
+	// time the worker has started to work at the target position (0 if not started)
+	uint64 workStarted = 0;
+};
+
+/**
+* Simulation of locally controlled workers; data of all workers are stored in contiguous arrays
+* and the logic of each state is processed in a single pass over them
+* Nodes of the workers serve only as proxies for the view and the network; their transformation
+* and state are updated at the end of each pass
+*/
+class WorkerSystem {
+private:
+	GameModel* gameModel = nullptr;
+	// limits of the movement of workers
+	SteeringParams steeringParams;
+	// time it takes to build a bridge [ms]
+	int buildingDelay = 0;
+	// time it takes to destroy a bridge [ms]
+	int destroyDelay = 0;
+
+	// proxy nodes of workers
+	vector<Node*> nodes;
+	// positions, velocities and targets of workers
+	SteeringData steering;
+	// rotations of workers [deg]
+	vector<float> rotations;
+	// factions of workers
+	vector<Faction> factions;
+	// states of workers
+	vector<WorkerState> states;
+	// paths the workers follow
+	vector<WorkerPath> paths;
+	// tasks the workers process
+	vector<WorkerJob> jobs;
+	// indicators whether an idle worker should keep its heading (it has just finished a task)
+	vector<bool> keepHeadings;
+	// indices of workers by the ids of their nodes
+	std::unordered_map<int, int> indices;
+	// width of the map, in tiles
+	int mapWidth = 0;
+	// height of the map, in tiles
+	int mapHeight = 0;
+	// indices of separation buckets by the tiles occupied by workers
+	std::unordered_map<int, int> tileBuckets;
+	// number of workers in each separation bucket
+	vector<int> bucketSizes;
+	// workers in the separation buckets, WORKER_SEPARATION_NEIGHBORS slots for each bucket
+	vector<int> buckets;
+
+public:
+
+	/**
+	* Initializes the system; the map of the model must be already loaded
+	*/
+	void Init(GameModel* gameModel);
+
+	/**
+	* Adds a new worker represented by selected proxy node
+	*/
+	void AddWorker(Node* node, Faction faction);
+
+	/**
+	* Changes faction of a worker
+	*/
+	void SetFaction(Node* node, Faction faction);
+
+	/**
+	* Gets number of simulated workers
+	*/
+	int GetWorkersNum() const {
+		return nodes.size();
+	}
+
+	/**
+	* Processes all workers
+	*/
+	void Update(const uint64 delta, const uint64 absolute);
+
+private:
+
+	/**
+	* Idle workers take reserved tasks or wander around
+	*/
+	void UpdateIdleWorkers(uint64 absolute);
+
+	/**
+	* Workers that go to a bridge build or destroy it when they get there
+	*/
+	void UpdateBuildingWorkers(uint64 absolute);
+
+	/**
+	* Workers that follow an attractor get idle when they reach it
+	*/
+	void UpdateAttractedWorkers(uint64 absolute);
+
+	/**
+	* Calculates forces that push each worker away from its nearest neighbours
+	* so that the workers don't stack at narrow places
+	*/
+	void SeparateWorkers();
+
+	/**
+	* Puts workers into the separation buckets of the tiles they stand at; only occupied tiles
+	* get a bucket and each bucket holds only up to WORKER_SEPARATION_NEIGHBORS workers
+	*/
+	void FillBuckets();
+
+	/**
+	* Moves all workers along their paths
+	*/
+	void IntegrateMovement(float deltaTime);
+
+	/**
+	* Sets the actual point of the path of a worker as its steering target
+	*/
+	void SetTarget(int index);
+
+	/**
+	* Copies positions and rotations of workers to their proxy nodes
+	*/
+	void SyncNodes();
+
+	/**
+	* Picks the nearest reserved task the worker can do
+	* @return true, if a task has been found
+	*/
+	bool FindTaskToDo(int index);
+
+	/**
+	* Sends an idle worker to a random position nearby
+	*/
+	void WanderAround(int index);
+
+	/**
+	* Sends a worker to build or destroy a bridge, working from selected tile
+	*/
+	void StartBuilding(int index, spt<GameTask> task, GameMapTile* tileToBuildFrom);
+
+	/**
+	* Sends a worker to follow an attractor by going to selected tile
+	* @param attractorRadius radius of the area around the attractor the tile has been picked from
+	*/
+	void StartAttracting(int index, spt<GameTask> task, GameMapTile* tileToFollow, int attractorRadius);
+
+	/**
+	* Finds a path to the attractor of the job of selected worker; the worker follows the flow field
+	* of the attractor into its area and only then searches for the path to its own target
+	* @param output output collection of steps
+	* @return false, if there is no path
+	*/
+	bool FindAttractorPath(int index, Vec2i start, vector<Vec2i>& output);
+
+	/**
+	* Finds a path to the target of the job of selected worker
+	* @return false, if there is no path
+	*/
+	bool RecalcPath(int index);
+
+	/**
+	* Returns true, if a cell of the actual path of the worker has become impassable
+	*/
+	bool IsPathBlocked(int index);
+
+	/**
+	* Aborts the task of the worker and releases it
+	*/
+	void AbortTask(int index);
+
+	/**
+	* Changes state of a worker, including the state of its proxy node
+	*/
+	void ChangeState(int index, WorkerState state);
+
+	/**
+	* Stops movement of a worker
+	*/
+	void Stop(int index);
+
+	/**
+	* Gets position of a worker
+	*/
+	ofVec2f GetPosition(int index) const {
+		return ofVec2f(steering.positionsX[index], steering.positionsY[index]);
+	}
+
+	/**
+	* Returns true, if the task of the worker has been removed from the model
+	*/
+	bool IsTaskRemoved(int index);
+
+	/**
+	* Gets name of the state of a proxy node
+	*/
+	StrId GetStateName(WorkerState state) const;
+};
@@ -59,9 +59,8 @@ void AttractorPlacement::OnMessage(Msg& msg) {
 					auto clickedNode = gameModel->GetMap()->GetTile(brickPos.x, brickPos.y);
 
 					// don't place attractor nearby another
-					for (auto& attr : attractors) {
-						if (Vec2i::Distance(attr->GetAttr<Vec2i>(ATTR_BRICK_POS), brickPos) < 4) return;
-					}
+					if (gameModel->IsNearAttractor(playerModel->GetFaction(), ofVec2f(brickPos.x + 0.5f, brickPos.y + 0.5f),
+						ATTRACTOR_PLACEMENT_DISTANCE)) return;
 
 					if (attrPlaced >= maxAttractors) {
 						// remove first attractor
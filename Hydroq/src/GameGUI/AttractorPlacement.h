@@ -7,6 +7,9 @@
 #include "GameModel.h"
 #include "PlayerModel.h"
 
+// minimal distance between two attractors, in tiles
+#define ATTRACTOR_PLACEMENT_DISTANCE 4
+
 /**
 * Behavior that reacts on user actions and places attractors into
 * the game model
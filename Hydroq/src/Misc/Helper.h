@@ -8,7 +8,7 @@ namespace Cog {
 	class Node;
 }
 
-enum class MapTileType;
+enum class MapTileType : unsigned char;
 
 /**
 * Static class with helping methods
@@ -49,6 +49,7 @@ enum class HydroqAction {
 #define ACT_SERVER_FOUND "SERVER_FOUND"
 #define ACT_SYNC_OBJECT_CHANGED "SYNC_OBJECT_CHANGED"
 #define ACT_GAMESTATE_CHANGED "GAMESTATE_CHANGED"
+#define ACT_SCHEDULING_CHANGED "SCHEDULING_CHANGED"
 
 // attributes
 #define ATTR_SEEDBED_FREQUENCY "SEEDBED_FREQUENCY"
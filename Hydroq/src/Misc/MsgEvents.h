@@ -81,6 +81,42 @@ public:
 	}
 };
 
+/**
+* Type of change that affects scheduling of tasks
+*/
+enum class SchedulingChangeType {
+	TASK_CREATED,		/** new task has been created */
+	WORKER_FREED,		/** worker has finished or abandoned its task */
+	PLATFORM_BUILT,		/** new platform has been built */
+	WORKER_SPAWNED,		/** new worker has been spawned or has joined the faction */
+	ATTRACTORS_CHANGED	/** attractor has been added, removed or resized (the shares of workers have changed) */
+};
+
+/**
+* Event which occurs when the task scheduler should reconsider some tasks
+*/
+class SchedulingChangedEvent : public MsgPayload {
+public:
+	// type of change
+	SchedulingChangeType changeType;
+	// concerned faction
+	Faction faction;
+	// concerned task (only for created tasks)
+	spt<GameTask> task;
+
+	SchedulingChangedEvent(SchedulingChangeType changeType, Faction faction) :
+		changeType(changeType), faction(faction)
+	{
+
+	}
+
+	SchedulingChangedEvent(SchedulingChangeType changeType, Faction faction, spt<GameTask> task) :
+		changeType(changeType), faction(faction), task(task)
+	{
+
+	}
+};
+
 /**
 * Event that occurs when a user clicks on a sprite inside the gameboard
 */